@@ -1,19 +1,50 @@
 #include <algorithm>
 #include <cmath>
+#include <istream>
+#include <limits>
+#include <memory_resource>
+#include <ostream>
+#include <stdexcept>
 #include <string>
+#include <type_traits>
 #include <vector>
+#include "bigint_arena.hpp"
+#include "bigint_multiply.hpp"
+#include "bigint_simd.hpp"
 
 const int BASE = 1000;
 
+struct bigint_ref;
+
+template <typename Lhs, typename Rhs, bool Subtract>
+struct bigint_sum;
+
+template <std::size_t Bits>
+struct fixed_bigint;
+
 struct bigint {
 private:
-    std::vector<unsigned> digits;
+    std::pmr::vector<unsigned> digits{bigint_arena::current_resource()};
 
 public:
     bigint() {
         digits.push_back(0);
     }
 
+    // Copies allocate from the resource that is current at the copy site,
+    // not from the one that owns the source.
+    bigint(const bigint &other)
+        : digits(other.digits, bigint_arena::current_resource()) {
+    }
+
+    bigint(bigint &&other) = default;
+
+    bigint &operator=(const bigint &other) = default;
+
+    bigint &operator=(bigint &&other) = default;
+
+    ~bigint() = default;
+
     // cppcheck-suppress noExplicitConstructor
     bigint(unsigned number) {
         if (number == 0) {
@@ -82,6 +113,28 @@ public:
         return basic_string;
     }
 
+    // Compact binary form: the number of limbs as a LEB128 varint, then the
+    // limbs packed three per 32-bit little-endian word (limb0 + limb1 * BASE
+    // + limb2 * BASE^2), about 2.2 times smaller than to_string().
+    void serialize(std::vector<unsigned char> &out) const;
+
+    [[nodiscard]] std::vector<unsigned char> serialize() const {
+        std::vector<unsigned char> out;
+        serialize(out);
+        return out;
+    }
+
+    // Decodes one value starting at `cursor` and advances it past the value.
+    // Throws std::invalid_argument on truncated or malformed input.
+    static bigint
+    deserialize(const unsigned char *&cursor, const unsigned char *end);
+
+    void serialize(std::ostream &out) const;
+
+    // Reads one value from the stream. Returns false at a clean end of
+    // stream, throws std::invalid_argument if the stream ends mid-value.
+    static bool deserialize(std::istream &in, bigint &result);
+
     friend bool operator==(const bigint &lhs, const bigint &rhs);
 
     friend bool operator!=(const bigint &lhs, const bigint &rhs);
@@ -94,33 +147,86 @@ public:
 
     friend bool operator<=(const bigint &lhs, const bigint &rhs);
 
-    friend bigint operator+(const bigint &lhs, const bigint &rhs);
+    friend bigint_sum<bigint_ref, bigint_ref, false>
+    operator+(const bigint &lhs, const bigint &rhs);
 
     friend bigint operator+=(bigint &lhs, const bigint &rhs);
 
-    friend bigint operator-(const bigint &lhs, const bigint &rhs);
+    friend bigint_sum<bigint_ref, bigint_ref, true>
+    operator-(const bigint &lhs, const bigint &rhs);
 
     friend bigint operator-=(bigint &lhs, const bigint &rhs);
+
+    friend bigint operator*(const bigint &lhs, const bigint &rhs);
+
+    friend bigint operator*=(bigint &lhs, const bigint &rhs);
+
+    friend bigint operator/(const bigint &lhs, const bigint &rhs);
+
+    friend bigint operator/=(bigint &lhs, const bigint &rhs);
+
+    friend bigint operator%(const bigint &lhs, const bigint &rhs);
+
+    friend bigint operator%=(bigint &lhs, const bigint &rhs);
+
+    friend bigint
+    pow_mod(const bigint &base, const bigint &exponent, const bigint &modulus);
+
+    friend struct montgomery_context;
+
+    friend struct bigint_ref;
+
+    template <typename Lhs, typename Rhs, bool Subtract>
+    friend struct bigint_sum;
+
+    template <std::size_t Bits>
+    friend struct fixed_bigint;
+
+private:
+    struct uninitialized_tag {};
+
+    // Exactly `size` zero limbs in a single allocation; callers normalize.
+    bigint(uninitialized_tag, std::size_t size)
+        : digits(size, 0, bigint_arena::current_resource()) {
+    }
+
+    static bigint add(const bigint &lhs, const bigint &rhs);
+
+    static bigint subtract(const bigint &lhs, const bigint &rhs);
+
+    [[nodiscard]] bool is_zero() const {
+        return digits.size() == 1 && digits[0] == 0;
+    }
+
+    static void divide(
+        const bigint &lhs,
+        const bigint &rhs,
+        bigint &quotient,
+        bigint &remainder
+    );
+
+    [[nodiscard]] std::vector<bool> to_binary() const;
 };
 
 bool operator==(const bigint &lhs, const bigint &rhs) {
-    return lhs.digits == rhs.digits;
+    return lhs.digits.size() == rhs.digits.size() &&
+           bigint_simd::active().highest_difference(
+               lhs.digits.data(), rhs.digits.data(), lhs.digits.size()
+           ) == 0;
 }
 
 bool operator!=(const bigint &lhs, const bigint &rhs) {
-    return lhs.digits != rhs.digits;
+    return !(lhs == rhs);
 }
 
 bool operator<(const bigint &lhs, const bigint &rhs) {
     if (lhs.digits.size() != rhs.digits.size()) {
         return lhs.digits.size() < rhs.digits.size();
     }
-    for (std::size_t i = lhs.digits.size(); i > 0; i--) {
-        if (lhs.digits[i - 1] != rhs.digits[i - 1]) {
-            return lhs.digits[i - 1] < rhs.digits[i - 1];
-        }
-    }
-    return false;
+    std::size_t i = bigint_simd::active().highest_difference(
+        lhs.digits.data(), rhs.digits.data(), lhs.digits.size()
+    );
+    return i != 0 && lhs.digits[i - 1] < rhs.digits[i - 1];
 }
 
 bool operator>(const bigint &lhs, const bigint &rhs) {
@@ -135,55 +241,748 @@ bool operator<=(const bigint &lhs, const bigint &rhs) {
     return !(lhs > rhs);
 }
 
-bigint operator+(const bigint &lhs, const bigint &rhs) {
-    bigint result;
-    std::size_t max_size = std::max(lhs.digits.size(), rhs.digits.size());
-    result.digits = std::vector<unsigned>(max_size + 1, 0);
+bigint bigint::add(const bigint &lhs, const bigint &rhs) {
+    const bigint &longer = lhs.digits.size() < rhs.digits.size() ? rhs : lhs;
+    const bigint &shorter = lhs.digits.size() < rhs.digits.size() ? lhs : rhs;
+    bigint result(uninitialized_tag{}, longer.digits.size() + 1);
+
+    unsigned carry = bigint_simd::active().add(
+        longer.digits.data(), shorter.digits.data(), result.digits.data(),
+        shorter.digits.size(), BASE, 0
+    );
+    for (std::size_t i = shorter.digits.size(); i < longer.digits.size();
+         i++) {
+        unsigned sum = longer.digits[i] + carry;
+        carry = sum == BASE ? 1 : 0;
+        result.digits[i] = sum - carry * BASE;
+    }
+    result.digits.back() = carry;
+    result.delete_leading_zeros_from_bigint();
+    return result;
+}
+
+bigint operator+=(bigint &lhs, const bigint &rhs) {
+    lhs = bigint::add(lhs, rhs);
+    return lhs;
+}
+
+bigint bigint::subtract(const bigint &lhs, const bigint &rhs) {
+    if (rhs.digits.size() > lhs.digits.size()) {
+        throw std::underflow_error("Negative bigint");
+    }
+    bigint result(uninitialized_tag{}, lhs.digits.size());
+    std::size_t common = rhs.digits.size();
+
+    unsigned borrow = bigint_simd::active().subtract(
+        lhs.digits.data(), rhs.digits.data(), result.digits.data(), common,
+        BASE, 0
+    );
+    for (std::size_t i = common; i < lhs.digits.size(); i++) {
+        unsigned next_borrow = lhs.digits[i] < borrow ? 1 : 0;
+        result.digits[i] = lhs.digits[i] + next_borrow * BASE - borrow;
+        borrow = next_borrow;
+    }
+    if (borrow != 0) {
+        throw std::underflow_error("Negative bigint");
+    }
+    result.delete_leading_zeros_from_bigint();
+    return result;
+}
+
+bigint operator-=(bigint &lhs, const bigint &rhs) {
+    lhs = bigint::subtract(lhs, rhs);
+    return lhs;
+}
+
+// Lazy sums and differences. `a + b + c - d` builds a tree of bigint_sum
+// nodes that references its operands; converting the tree to a bigint adds
+// up all the operands limb by limb in a single pass, into one buffer sized
+// up front. A single `a + b` or `a - b` goes through the vectorized kernels.
+//
+// The tree does not own bigint operands, so it must be converted before the
+// end of the full expression that created it: `bigint s = a + b;` is fine,
+// `auto s = f() + b;` dangles.
+struct bigint_ref {
+    static constexpr std::size_t terms = 1;
+
+    const bigint &value;
+
+    [[nodiscard]] std::size_t size() const {
+        return value.digits.size();
+    }
+
+    [[nodiscard]] long long limb(std::size_t index) const {
+        return index < value.digits.size() ? value.digits[index] : 0;
+    }
+};
+
+// An integral operand, such as the 1 in `a + b + 1`, split into limbs
+// without allocating.
+struct bigint_small {
+    static constexpr std::size_t terms = 1;
+    static constexpr std::size_t max_limbs = 4;
+
+    explicit bigint_small(unsigned number) {
+        while (number != 0) {
+            limbs[limbs_count++] = number % BASE;
+            number /= BASE;
+        }
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return limbs_count;
+    }
+
+    [[nodiscard]] long long limb(std::size_t index) const {
+        return index < limbs_count ? limbs[index] : 0;
+    }
+
+private:
+    unsigned limbs[max_limbs] = {};
+    std::size_t limbs_count = 0;
+};
+
+template <typename Lhs, typename Rhs, bool Subtract>
+struct bigint_sum {
+    static constexpr std::size_t terms = Lhs::terms + Rhs::terms;
+
+    Lhs lhs;
+    Rhs rhs;
 
-    for (std::size_t i = 0; i < max_size; i++) {
-        if (i < lhs.digits.size()) {
-            result.digits[i] += lhs.digits[i];
+    [[nodiscard]] std::size_t size() const {
+        return std::max(lhs.size(), rhs.size());
+    }
+
+    [[nodiscard]] long long limb(std::size_t index) const {
+        return Subtract ? lhs.limb(index) - rhs.limb(index)
+                        : lhs.limb(index) + rhs.limb(index);
+    }
+
+    // cppcheck-suppress noExplicitConstructor
+    operator bigint() const {
+        if constexpr (std::is_same_v<Lhs, bigint_ref> &&
+                      std::is_same_v<Rhs, bigint_ref>) {
+            return Subtract ? bigint::subtract(lhs.value, rhs.value)
+                            : bigint::add(lhs.value, rhs.value);
+        } else {
+            return evaluate();
+        }
+    }
+
+    [[nodiscard]] std::string to_string() const {
+        return bigint(*this).to_string();
+    }
+
+private:
+    [[nodiscard]] bigint evaluate() const {
+        std::size_t carry_limbs = 1;
+        for (std::size_t count = terms; count >= BASE; count /= BASE) {
+            carry_limbs++;
+        }
+        const std::size_t limbs = size();
+        bigint result(bigint::uninitialized_tag{}, limbs + carry_limbs);
+
+        long long carry = 0;
+        for (std::size_t i = 0; i < limbs; i++) {
+            long long value = limb(i) + carry;
+            long long digit = value % BASE;
+            if (digit < 0) {
+                digit += BASE;
+            }
+            result.digits[i] = static_cast<unsigned>(digit);
+            carry = (value - digit) / BASE;
+        }
+        if (carry < 0) {
+            throw std::underflow_error("Negative bigint");
         }
-        if (i < rhs.digits.size()) {
-            result.digits[i] += rhs.digits[i];
+        for (std::size_t i = limbs; carry != 0; i++) {
+            result.digits[i] = static_cast<unsigned>(carry % BASE);
+            carry /= BASE;
         }
-        result.digits[i + 1] += result.digits[i] / BASE;
-        result.digits[i] %= BASE;
+        result.delete_leading_zeros_from_bigint();
+        return result;
     }
+};
+
+template <typename T>
+struct bigint_operand {
+    using type = bigint_small;
+};
+
+template <>
+struct bigint_operand<bigint> {
+    using type = bigint_ref;
+};
+
+template <typename Lhs, typename Rhs, bool Subtract>
+struct bigint_operand<bigint_sum<Lhs, Rhs, Subtract>> {
+    using type = bigint_sum<Lhs, Rhs, Subtract>;
+};
+
+template <typename T>
+struct is_bigint_sum : std::false_type {};
+
+template <typename Lhs, typename Rhs, bool Subtract>
+struct is_bigint_sum<bigint_sum<Lhs, Rhs, Subtract>> : std::true_type {};
+
+template <typename T>
+constexpr bool is_bigint_operand_v =
+    std::is_same_v<T, bigint> || is_bigint_sum<T>::value ||
+    std::is_integral_v<T>;
+
+// Plain bigint + bigint is handled by the non-template overloads; these
+// extend an existing tree.
+template <typename Lhs, typename Rhs>
+constexpr bool extends_bigint_sum_v =
+    is_bigint_operand_v<Lhs> && is_bigint_operand_v<Rhs> &&
+    (is_bigint_sum<Lhs>::value || is_bigint_sum<Rhs>::value);
+
+template <typename T>
+typename bigint_operand<T>::type make_bigint_operand(const T &operand) {
+    if constexpr (std::is_integral_v<T>) {
+        return bigint_small(static_cast<unsigned>(operand));
+    } else if constexpr (std::is_same_v<T, bigint>) {
+        return bigint_ref{operand};
+    } else {
+        return operand;
+    }
+}
+
+bigint_sum<bigint_ref, bigint_ref, false>
+operator+(const bigint &lhs, const bigint &rhs) {
+    return {bigint_ref{lhs}, bigint_ref{rhs}};
+}
+
+bigint_sum<bigint_ref, bigint_ref, true>
+operator-(const bigint &lhs, const bigint &rhs) {
+    return {bigint_ref{lhs}, bigint_ref{rhs}};
+}
+
+template <
+    typename Lhs,
+    typename Rhs,
+    typename = std::enable_if_t<extends_bigint_sum_v<Lhs, Rhs>>>
+bigint_sum<
+    typename bigint_operand<Lhs>::type,
+    typename bigint_operand<Rhs>::type,
+    false>
+operator+(const Lhs &lhs, const Rhs &rhs) {
+    return {make_bigint_operand(lhs), make_bigint_operand(rhs)};
+}
+
+template <
+    typename Lhs,
+    typename Rhs,
+    typename = std::enable_if_t<extends_bigint_sum_v<Lhs, Rhs>>>
+bigint_sum<
+    typename bigint_operand<Lhs>::type,
+    typename bigint_operand<Rhs>::type,
+    true>
+operator-(const Lhs &lhs, const Rhs &rhs) {
+    return {make_bigint_operand(lhs), make_bigint_operand(rhs)};
+}
+
+bigint operator*(const bigint &lhs, const bigint &rhs) {
+    bigint result(
+        bigint::uninitialized_tag{}, lhs.digits.size() + rhs.digits.size()
+    );
+    bigint_multiply::multiply(
+        lhs.digits.data(), lhs.digits.size(), rhs.digits.data(),
+        rhs.digits.size(), result.digits.data(), BASE
+    );
     result.delete_leading_zeros_from_bigint();
     return result;
 }
 
-bigint operator+=(bigint &lhs, const bigint &rhs) {
-    lhs = lhs + rhs;
+bigint operator*=(bigint &lhs, const bigint &rhs) {
+    lhs = lhs * rhs;
     return lhs;
 }
 
-bigint operator-(const bigint &lhs, const bigint &rhs) {
-    bigint result;
-    result.digits = lhs.digits;
+void bigint::divide(
+    const bigint &lhs,
+    const bigint &rhs,
+    bigint &quotient,
+    bigint &remainder
+) {
+    if (rhs.is_zero()) {
+        throw std::domain_error("Division by zero");
+    }
+    quotient.digits.assign(lhs.digits.size(), 0);
+    remainder = bigint();
+    for (std::size_t i = lhs.digits.size(); i > 0; i--) {
+        remainder.digits.insert(remainder.digits.begin(), lhs.digits[i - 1]);
+        remainder.delete_leading_zeros_from_bigint();
+        unsigned low = 0;
+        unsigned high = BASE - 1;
+        while (low < high) {
+            unsigned middle = (low + high + 1) / 2;
+            if (rhs * bigint(middle) <= remainder) {
+                low = middle;
+            } else {
+                high = middle - 1;
+            }
+        }
+        quotient.digits[i - 1] = low;
+        if (low != 0) {
+            remainder -= rhs * bigint(low);
+        }
+    }
+    quotient.delete_leading_zeros_from_bigint();
+}
 
-    for (std::size_t i = 0; i < lhs.digits.size(); i++) {
-        if (i < rhs.digits.size()) {
-            if (result.digits[i] < rhs.digits[i]) {
-                result.digits[i] += BASE;
-                result.digits[i] -= rhs.digits[i];
-                std::size_t j = i + 1;
-                while (result.digits[j] == 0) {
-                    result.digits[j] += BASE - 1;
-                    j++;
-                }
-                result.digits[j]--;
+bigint operator/(const bigint &lhs, const bigint &rhs) {
+    bigint quotient;
+    bigint remainder;
+    bigint::divide(lhs, rhs, quotient, remainder);
+    return quotient;
+}
+
+bigint operator/=(bigint &lhs, const bigint &rhs) {
+    lhs = lhs / rhs;
+    return lhs;
+}
+
+bigint operator%(const bigint &lhs, const bigint &rhs) {
+    bigint quotient;
+    bigint remainder;
+    bigint::divide(lhs, rhs, quotient, remainder);
+    return remainder;
+}
+
+bigint operator%=(bigint &lhs, const bigint &rhs) {
+    lhs = lhs % rhs;
+    return lhs;
+}
+
+// Bits of the number, least significant first. The number is peeled off
+// 16 bits at a time so that the conversion stays quadratic in the number of
+// limbs instead of being quadratic in the number of bits.
+std::vector<bool> bigint::to_binary() const {
+    const unsigned chunk_bits = 16;
+    const unsigned chunk = 1U << chunk_bits;
+    std::vector<unsigned> current(digits.begin(), digits.end());
+    std::vector<bool> bits;
+    while (current.size() > 1 || current[0] != 0) {
+        unsigned remainder = 0;
+        for (std::size_t i = current.size(); i > 0; i--) {
+            unsigned value = remainder * BASE + current[i - 1];
+            current[i - 1] = value / chunk;
+            remainder = value % chunk;
+        }
+        while (current.size() > 1 && current.back() == 0) {
+            current.pop_back();
+        }
+        for (unsigned bit = 0; bit < chunk_bits; bit++) {
+            bits.push_back(((remainder >> bit) & 1U) != 0);
+        }
+    }
+    while (!bits.empty() && !bits.back()) {
+        bits.pop_back();
+    }
+    return bits;
+}
+
+// Precomputed state for arithmetic modulo a fixed odd modulus coprime with
+// BASE. Numbers are kept in Montgomery form x * R mod m, where R = BASE^n and
+// n is the number of limbs of the modulus, so that every modular
+// multiplication needs no division at all. Building a context costs one
+// division; every pow() call afterwards reuses it.
+struct montgomery_context {
+    explicit montgomery_context(const bigint &modulus)
+        : m_modulus(modulus),
+          m_limbs(modulus.digits.begin(), modulus.digits.end()),
+          m_inverse(negated_inverse(modulus)) {
+        bigint r_squared = 1;
+        r_squared.digits.assign(2 * m_limbs.size() + 1, 0);
+        r_squared.digits.back() = 1;
+        m_r_squared = to_limbs(r_squared % m_modulus);
+    }
+
+    [[nodiscard]] static bool supports(const bigint &modulus) {
+        return modulus > bigint(1) && modulus.digits[0] % 2 != 0 &&
+               modulus.digits[0] % 5 != 0;
+    }
+
+    [[nodiscard]] const bigint &modulus() const {
+        return m_modulus;
+    }
+
+    [[nodiscard]] bigint multiply(const bigint &lhs, const bigint &rhs) const {
+        return from_montgomery(
+            reduce_product(to_montgomery(lhs), to_montgomery(rhs))
+        );
+    }
+
+    [[nodiscard]] bigint
+    pow(const bigint &base, const bigint &exponent) const {
+        std::vector<bool> bits = exponent.to_binary();
+        limbs one = to_montgomery(bigint(1));
+        if (bits.empty()) {
+            return from_montgomery(one);
+        }
+
+        // Sliding window: odd powers base^1, base^3, ..., base^(2^k - 1) are
+        // tabulated so that every window of up to k bits costs one
+        // multiplication.
+        const unsigned window = window_size(bits.size());
+        limbs base_montgomery = to_montgomery(base);
+        limbs base_squared = reduce_product(base_montgomery, base_montgomery);
+        std::vector<limbs> odd_powers(std::size_t(1) << (window - 1));
+        odd_powers[0] = base_montgomery;
+        for (std::size_t i = 1; i < odd_powers.size(); i++) {
+            odd_powers[i] = reduce_product(odd_powers[i - 1], base_squared);
+        }
+
+        limbs result = one;
+        std::size_t position = bits.size();
+        while (position > 0) {
+            if (!bits[position - 1]) {
+                result = reduce_product(result, result);
+                position--;
+                continue;
+            }
+            std::size_t low = position > window ? position - window : 0;
+            while (!bits[low]) {
+                low++;
+            }
+            std::size_t value = 0;
+            for (std::size_t i = position; i > low; i--) {
+                result = reduce_product(result, result);
+                value = value * 2 + (bits[i - 1] ? 1 : 0);
+            }
+            result = reduce_product(result, odd_powers[value / 2]);
+            position = low;
+        }
+        return from_montgomery(result);
+    }
+
+private:
+    using limbs = std::vector<unsigned>;
+
+    bigint m_modulus;
+    limbs m_limbs;
+    unsigned m_inverse;
+    limbs m_r_squared;
+
+    static unsigned negated_inverse(const bigint &modulus) {
+        if (!supports(modulus)) {
+            throw std::invalid_argument(
+                "Montgomery modulus must be coprime with the base"
+            );
+        }
+        const unsigned low = modulus.digits[0];
+        for (unsigned candidate = 1; candidate < BASE; candidate++) {
+            if (low * candidate % BASE == BASE - 1) {
+                return candidate;
+            }
+        }
+        return 0;
+    }
+
+    static unsigned window_size(std::size_t exponent_bits) {
+        if (exponent_bits <= 24) {
+            return 1;
+        }
+        if (exponent_bits <= 80) {
+            return 3;
+        }
+        if (exponent_bits <= 240) {
+            return 4;
+        }
+        if (exponent_bits <= 672) {
+            return 5;
+        }
+        return 6;
+    }
+
+    [[nodiscard]] limbs to_limbs(const bigint &number) const {
+        limbs result(m_limbs.size(), 0);
+        std::copy(number.digits.begin(), number.digits.end(), result.begin());
+        return result;
+    }
+
+    [[nodiscard]] limbs to_montgomery(const bigint &number) const {
+        return reduce_product(to_limbs(number % m_modulus), m_r_squared);
+    }
+
+    [[nodiscard]] bigint from_montgomery(const limbs &number) const {
+        limbs one(m_limbs.size(), 0);
+        one[0] = 1;
+        limbs reduced = reduce_product(number, one);
+        bigint result;
+        result.digits.assign(reduced.begin(), reduced.end());
+        result.delete_leading_zeros_from_bigint();
+        return result;
+    }
+
+    // REDC(lhs * rhs): the product divided by R modulo m. Both operands and
+    // the result are n-limb numbers less than m.
+    [[nodiscard]] limbs
+    reduce_product(const limbs &lhs, const limbs &rhs) const {
+        const std::size_t size = m_limbs.size();
+        std::vector<unsigned long long> product(2 * size + 1, 0);
+        for (std::size_t i = 0; i < size; i++) {
+            if (lhs[i] == 0) {
+                continue;
+            }
+            for (std::size_t j = 0; j < size; j++) {
+                product[i + j] +=
+                    static_cast<unsigned long long>(lhs[i]) * rhs[j];
+            }
+        }
+        for (std::size_t i = 0; i < size; i++) {
+            product[i + 1] += product[i] / BASE;
+            product[i] %= BASE;
+            const unsigned long long factor =
+                product[i] * m_inverse % BASE;
+            for (std::size_t j = 0; j < size; j++) {
+                product[i + j] += factor * m_limbs[j];
+            }
+            product[i + 1] += product[i] / BASE;
+        }
+        limbs result(size + 1, 0);
+        unsigned long long carry = 0;
+        for (std::size_t i = 0; i <= size; i++) {
+            carry += product[size + i];
+            result[i] = static_cast<unsigned>(carry % BASE);
+            carry /= BASE;
+        }
+        if (!is_less(result, m_limbs)) {
+            subtract_modulus(result);
+        }
+        result.resize(size);
+        return result;
+    }
+
+    [[nodiscard]] static bool is_less(const limbs &lhs, const limbs &rhs) {
+        for (std::size_t i = lhs.size(); i > 0; i--) {
+            unsigned right = i - 1 < rhs.size() ? rhs[i - 1] : 0;
+            if (lhs[i - 1] != right) {
+                return lhs[i - 1] < right;
+            }
+        }
+        return false;
+    }
+
+    void subtract_modulus(limbs &number) const {
+        unsigned borrow = 0;
+        for (std::size_t i = 0; i < number.size(); i++) {
+            unsigned subtrahend =
+                (i < m_limbs.size() ? m_limbs[i] : 0) + borrow;
+            if (number[i] < subtrahend) {
+                number[i] += BASE - subtrahend;
+                borrow = 1;
             } else {
-                result.digits[i] -= rhs.digits[i];
+                number[i] -= subtrahend;
+                borrow = 0;
             }
         }
     }
+};
+
+// a^b mod m. Moduli coprime with BASE go through Montgomery arithmetic; the
+// rest fall back to square-and-multiply with a division per step. Callers
+// raising many numbers to powers modulo the same m should build a
+// montgomery_context once and call its pow() directly.
+bigint
+pow_mod(const bigint &base, const bigint &exponent, const bigint &modulus) {
+    if (modulus == bigint(1)) {
+        return 0;
+    }
+    if (montgomery_context::supports(modulus)) {
+        return montgomery_context(modulus).pow(base, exponent);
+    }
+    if (modulus == bigint()) {
+        throw std::domain_error("Division by zero");
+    }
+    std::vector<bool> bits = exponent.to_binary();
+    bigint result = 1;
+    bigint power = base % modulus;
+    for (bool bit : bits) {
+        if (bit) {
+            result = result * power % modulus;
+        }
+        power = power * power % modulus;
+    }
+    return result;
+}
+
+namespace bigint_encoding {
+const unsigned LIMBS_PER_WORD = 3;
+const unsigned WORD_BYTES = 4;
+// Streams are read in pieces of this size, so a corrupt length fails at the
+// end of the data instead of allocating whatever it claims.
+const std::size_t STREAM_CHUNK_BYTES = 1 << 16;
+
+inline std::size_t word_count(std::size_t limbs) {
+    return (limbs + LIMBS_PER_WORD - 1) / LIMBS_PER_WORD;
+}
+
+inline void write_varint(std::size_t value, unsigned char *&out) {
+    while (value >= 0x80) {
+        *out++ = static_cast<unsigned char>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<unsigned char>(value);
+}
+
+inline void invalid() {
+    throw std::invalid_argument("Invalid bigint encoding");
+}
+
+inline std::size_t
+read_varint(const unsigned char *&cursor, const unsigned char *end) {
+    std::size_t value = 0;
+    for (unsigned shift = 0;; shift += 7) {
+        if (cursor == end || shift >= 8 * sizeof(std::size_t)) {
+            invalid();
+        }
+        const unsigned char byte = *cursor++;
+        const unsigned payload = byte & 0x7F;
+        // The last group may only carry the bits that are left.
+        const unsigned bits_left = 8 * sizeof(std::size_t) - shift;
+        if (bits_left < 7 && (payload >> bits_left) != 0) {
+            invalid();
+        }
+        value |= static_cast<std::size_t>(payload) << shift;
+        if ((byte & 0x80) == 0) {
+            return value;
+        }
+    }
+}
+}  // namespace bigint_encoding
+
+void bigint::serialize(std::vector<unsigned char> &out) const {
+    using namespace bigint_encoding;
+    const std::size_t words = word_count(digits.size());
+    const std::size_t offset = out.size();
+    out.resize(offset + sizeof(std::size_t) * 8 / 7 + 1 + words * WORD_BYTES);
+    unsigned char *cursor = out.data() + offset;
+    write_varint(digits.size(), cursor);
+    for (std::size_t i = 0; i < digits.size(); i += LIMBS_PER_WORD) {
+        unsigned word = 0;
+        for (std::size_t j = std::min<std::size_t>(digits.size(), i + 3);
+             j > i; j--) {
+            word = word * BASE + digits[j - 1];
+        }
+        for (unsigned byte = 0; byte < WORD_BYTES; byte++) {
+            *cursor++ = static_cast<unsigned char>(word >> (8 * byte));
+        }
+    }
+    out.resize(static_cast<std::size_t>(cursor - out.data()));
+}
+
+bigint
+bigint::deserialize(const unsigned char *&cursor, const unsigned char *end) {
+    using namespace bigint_encoding;
+    const std::size_t limbs = read_varint(cursor, end);
+    // Compared without word_count, which wraps around for huge counts.
+    const std::size_t available_words =
+        static_cast<std::size_t>(end - cursor) / WORD_BYTES;
+    if (limbs == 0 || limbs > available_words * LIMBS_PER_WORD) {
+        invalid();
+    }
+    bigint result(uninitialized_tag{}, word_count(limbs) * LIMBS_PER_WORD);
+    for (std::size_t i = 0; i < limbs; i += LIMBS_PER_WORD) {
+        unsigned word = 0;
+        for (unsigned byte = 0; byte < WORD_BYTES; byte++) {
+            word |= static_cast<unsigned>(*cursor++) << (8 * byte);
+        }
+        for (std::size_t j = i; j < i + LIMBS_PER_WORD; j++) {
+            result.digits[j] = word % BASE;
+            word /= BASE;
+        }
+        if (word != 0) {
+            invalid();
+        }
+    }
+    // The last word may hold fewer limbs than it has room for; the rest
+    // must be zero, or the encoding was not made by serialize().
+    for (std::size_t i = limbs; i < result.digits.size(); i++) {
+        if (result.digits[i] != 0) {
+            invalid();
+        }
+    }
+    result.digits.resize(limbs);
     result.delete_leading_zeros_from_bigint();
     return result;
 }
 
-bigint operator-=(bigint &lhs, const bigint &rhs) {
-    lhs = lhs - rhs;
-    return lhs;
+void bigint::serialize(std::ostream &out) const {
+    std::vector<unsigned char> buffer;
+    serialize(buffer);
+    out.write(
+        reinterpret_cast<const char *>(buffer.data()),
+        static_cast<std::streamsize>(buffer.size())
+    );
+}
+
+bool bigint::deserialize(std::istream &in, bigint &result) {
+    using namespace bigint_encoding;
+    std::vector<unsigned char> buffer;
+    int byte = in.get();
+    if (byte == std::istream::traits_type::eof()) {
+        return false;
+    }
+    buffer.push_back(static_cast<unsigned char>(byte));
+    while ((byte & 0x80) != 0) {
+        byte = in.get();
+        if (byte == std::istream::traits_type::eof() ||
+            buffer.size() > sizeof(std::size_t) * 8 / 7) {
+            invalid();
+        }
+        buffer.push_back(static_cast<unsigned char>(byte));
+    }
+    const unsigned char *cursor = buffer.data();
+    const std::size_t limbs =
+        read_varint(cursor, buffer.data() + buffer.size());
+    if (limbs == 0 ||
+        limbs > std::numeric_limits<std::size_t>::max() / WORD_BYTES) {
+        invalid();
+    }
+    for (std::size_t remaining = word_count(limbs) * WORD_BYTES;
+         remaining != 0;) {
+        const std::size_t chunk = std::min(remaining, STREAM_CHUNK_BYTES);
+        const std::size_t offset = buffer.size();
+        buffer.resize(offset + chunk);
+        in.read(
+            reinterpret_cast<char *>(buffer.data() + offset),
+            static_cast<std::streamsize>(chunk)
+        );
+        if (static_cast<std::size_t>(in.gcount()) != chunk) {
+            invalid();
+        }
+        remaining -= chunk;
+    }
+    cursor = buffer.data();
+    result = deserialize(cursor, buffer.data() + buffer.size());
+    return true;
 }
+
+// Iterates over bigints serialized back to back in one buffer.
+struct bigint_reader {
+    bigint_reader(const unsigned char *data, std::size_t size)
+        : cursor(data), end(data + size) {
+    }
+
+    explicit bigint_reader(const std::vector<unsigned char> &buffer)
+        : bigint_reader(buffer.data(), buffer.size()) {
+    }
+
+    [[nodiscard]] bool done() const {
+        return cursor == end;
+    }
+
+    bool next(bigint &result) {
+        if (done()) {
+            return false;
+        }
+        result = bigint::deserialize(cursor, end);
+        return true;
+    }
+
+private:
+    const unsigned char *cursor;
+    const unsigned char *end;
+};
@@ -0,0 +1,79 @@
+#ifndef BIGINT_ARENA_HPP_
+#define BIGINT_ARENA_HPP_
+
+#include <cstddef>
+#include <memory_resource>
+
+// Thread-local memory resource that bigint draws its limbs from. Outside of
+// any scope it is the global heap. A scope installs a bump allocator for the
+// current thread; every bigint created while it is active allocates from it
+// and deallocation is a no-op, so all temporaries of a computation are freed
+// at once when the scope ends.
+//
+// Every bigint constructed inside a scope must be destroyed before the scope
+// is. To keep a result, either assign it to a bigint declared outside the
+// scope, since assignment copies the limbs into the destination's own
+// resource, or return scope::keep(result). Returning or moving the result
+// itself does not work: the returned value is built while the scope is
+// still active and keeps pointing into the arena.
+namespace bigint_arena {
+
+inline std::pmr::memory_resource *&current_resource() {
+    thread_local std::pmr::memory_resource *resource =
+        std::pmr::new_delete_resource();
+    return resource;
+}
+
+struct scope {
+    explicit scope(std::size_t initial_size = 64 * 1024)
+        : previous(current_resource()), arena(initial_size, previous) {
+        current_resource() = &arena;
+    }
+
+    scope(void *buffer, std::size_t buffer_size)
+        : previous(current_resource()),
+          arena(buffer, buffer_size, previous) {
+        current_resource() = &arena;
+    }
+
+    scope(const scope &) = delete;
+
+    scope(scope &&) = delete;
+
+    scope &operator=(const scope &) = delete;
+
+    scope &operator=(scope &&) = delete;
+
+    ~scope() {
+        current_resource() = previous;
+    }
+
+    // Copy of value that allocates from the resource that was current when
+    // the scope was entered, so it outlives the scope:
+    //
+    //     bigint sum_of_squares(...) {
+    //         bigint_arena::scope scope;
+    //         bigint result = ...;
+    //         return scope.keep(result);
+    //     }
+    template <typename T>
+    [[nodiscard]] T keep(const T &value) {
+        current_resource() = previous;
+        try {
+            T result(value);
+            current_resource() = &arena;
+            return result;
+        } catch (...) {
+            current_resource() = &arena;
+            throw;
+        }
+    }
+
+private:
+    std::pmr::memory_resource *previous;
+    std::pmr::monotonic_buffer_resource arena;
+};
+
+}  // namespace bigint_arena
+
+#endif  // BIGINT_ARENA_HPP_
@@ -0,0 +1,508 @@
+// Benchmark and differential checker for bigint.
+//
+//     bigint_benchmark [max_digits] [fuzz_rounds] [seed]
+//
+// First every operation is checked against a naive decimal-string reference
+// implementation on random and edge-case operands; products large enough
+// for parallel Karatsuba are checked both on the shared task pool and on
+// one with several workers, whatever the machine. Any mismatch is printed
+// and the program exits with status 1 before timing anything. Then each
+// operation is timed on operands from one limb up to max_digits decimal
+// digits (10^6 by default) and reported in nanoseconds per operation.
+// fixed_bigint is checked against bigint arithmetic modulo 2^Bits, and its
+// constant expressions at compile time.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+// Includes bigint.inc.cpp.
+#include "fixed_bigint.inc.cpp"
+
+namespace reference {
+std::string strip(std::string number) {
+    std::size_t first = number.find_first_not_of('0');
+    return first == std::string::npos ? "0" : number.substr(first);
+}
+
+bool less(const std::string &lhs, const std::string &rhs) {
+    if (lhs.size() != rhs.size()) {
+        return lhs.size() < rhs.size();
+    }
+    return lhs < rhs;
+}
+
+std::string add(const std::string &lhs, const std::string &rhs) {
+    std::string result;
+    int carry = 0;
+    for (std::size_t i = 0; i < std::max(lhs.size(), rhs.size()) || carry;
+         i++) {
+        int sum = carry;
+        sum += i < lhs.size() ? lhs[lhs.size() - 1 - i] - '0' : 0;
+        sum += i < rhs.size() ? rhs[rhs.size() - 1 - i] - '0' : 0;
+        result.push_back(static_cast<char>('0' + sum % 10));
+        carry = sum / 10;
+    }
+    std::reverse(result.begin(), result.end());
+    return strip(result);
+}
+
+// lhs >= rhs.
+std::string subtract(const std::string &lhs, const std::string &rhs) {
+    std::string result;
+    int borrow = 0;
+    for (std::size_t i = 0; i < lhs.size(); i++) {
+        int difference = lhs[lhs.size() - 1 - i] - '0' - borrow;
+        difference -= i < rhs.size() ? rhs[rhs.size() - 1 - i] - '0' : 0;
+        borrow = difference < 0 ? 1 : 0;
+        result.push_back(static_cast<char>('0' + difference + 10 * borrow));
+    }
+    std::reverse(result.begin(), result.end());
+    return strip(result);
+}
+
+std::string multiply(const std::string &lhs, const std::string &rhs) {
+    std::vector<int> product(lhs.size() + rhs.size(), 0);
+    for (std::size_t i = 0; i < lhs.size(); i++) {
+        for (std::size_t j = 0; j < rhs.size(); j++) {
+            product[i + j + 1] += (lhs[i] - '0') * (rhs[j] - '0');
+        }
+    }
+    for (std::size_t i = product.size() - 1; i > 0; i--) {
+        product[i - 1] += product[i] / 10;
+        product[i] %= 10;
+    }
+    std::string result;
+    for (int digit : product) {
+        result.push_back(static_cast<char>('0' + digit));
+    }
+    return strip(result);
+}
+
+// {quotient, remainder}, rhs != 0.
+std::pair<std::string, std::string>
+divide(const std::string &lhs, const std::string &rhs) {
+    std::string quotient;
+    std::string remainder = "0";
+    for (char digit : lhs) {
+        remainder = strip(remainder + digit);
+        char count = '0';
+        while (!less(remainder, rhs)) {
+            remainder = subtract(remainder, rhs);
+            count++;
+        }
+        quotient.push_back(count);
+    }
+    return {strip(quotient), remainder};
+}
+
+std::string pow_mod(
+    const std::string &base,
+    unsigned exponent,
+    const std::string &modulus
+) {
+    std::string result = divide("1", modulus).second;
+    std::string power = divide(base, modulus).second;
+    for (; exponent != 0; exponent /= 2) {
+        if (exponent % 2 != 0) {
+            result = divide(multiply(result, power), modulus).second;
+        }
+        power = divide(multiply(power, power), modulus).second;
+    }
+    return result;
+}
+}  // namespace reference
+
+namespace {
+std::mt19937_64 &generator() {
+    static std::mt19937_64 engine;
+    return engine;
+}
+
+std::string random_number(std::size_t digits) {
+    std::uniform_int_distribution<int> digit('0', '9');
+    std::uniform_int_distribution<int> leading('1', '9');
+    std::string result(digits, '0');
+    result[0] = static_cast<char>(leading(generator()));
+    // Long runs of nines and zeros exercise carry and borrow chains.
+    const int mode = static_cast<int>(generator()() % 4);
+    for (std::size_t i = 1; i < digits; i++) {
+        result[i] = mode == 0   ? '9'
+                    : mode == 1 ? '0'
+                                : static_cast<char>(digit(generator()));
+    }
+    return result;
+}
+
+std::size_t random_size(std::size_t max_digits) {
+    return 1 + generator()() % max_digits;
+}
+
+// A random number of at most `digits` digits times a power of ten, or a
+// plain power of ten, so that the low limbs are all zero.
+std::string sparse_number(std::size_t digits) {
+    const std::size_t zeros = generator()() % digits;
+    const std::size_t head_digits = random_size(digits - zeros);
+    const std::string head =
+        generator()() % 4 == 0 ? "1" : random_number(head_digits);
+    return head + std::string(zeros, '0');
+}
+
+int mismatches = 0;
+
+void expect(
+    const std::string &operation,
+    const std::string &lhs,
+    const std::string &rhs,
+    const std::string &expected,
+    const std::string &actual
+) {
+    if (expected != actual) {
+        mismatches++;
+        std::cout << "MISMATCH " << operation << "\n  lhs=" << lhs
+                  << "\n  rhs=" << rhs << "\n  expected=" << expected
+                  << "\n  actual=" << actual << "\n";
+    }
+}
+
+void check_pair(const std::string &lhs, const std::string &rhs) {
+    const bigint a(lhs);
+    const bigint b(rhs);
+    expect("to_string", lhs, "", reference::strip(lhs), a.to_string());
+    expect(
+        "<", lhs, rhs, reference::less(lhs, rhs) ? "1" : "0",
+        a < b ? "1" : "0"
+    );
+    expect("==", lhs, rhs, lhs == rhs ? "1" : "0", a == b ? "1" : "0");
+    expect("+", lhs, rhs, reference::add(lhs, rhs), (a + b).to_string());
+    const bool ordered = !reference::less(lhs, rhs);
+    const std::string &larger = ordered ? lhs : rhs;
+    const std::string &smaller = ordered ? rhs : lhs;
+    expect(
+        "-", larger, smaller, reference::subtract(larger, smaller),
+        (bigint(larger) - bigint(smaller)).to_string()
+    );
+    expect(
+        "a + b + a - b", lhs, rhs, reference::add(lhs, lhs),
+        (a + b + a - b).to_string()
+    );
+    expect("*", lhs, rhs, reference::multiply(lhs, rhs), (a * b).to_string());
+    if (rhs != "0") {
+        auto [quotient, remainder] = reference::divide(lhs, rhs);
+        expect("/", lhs, rhs, quotient, (a / b).to_string());
+        expect("%", lhs, rhs, remainder, (a % b).to_string());
+    }
+}
+
+// fixed_bigint<Bits> must agree with bigint modulo 2^Bits. The values
+// include the wraparound edges and numbers too wide for Bits, which wrap
+// when converted.
+template <std::size_t Bits>
+void check_fixed_width(int rounds) {
+    using fixed = fixed_bigint<Bits>;
+    bigint modulus = 1;
+    for (std::size_t bit = 0; bit < Bits; bit++) {
+        modulus = modulus * bigint(2);
+    }
+    const std::string max = (modulus - bigint(1)).to_string();
+    std::vector<std::string> values = {
+        "0",          "1",         max, (modulus - bigint(2)).to_string(),
+        "4294967295", "4294967296", "999999999", "1000000000"};
+    for (int round = 0; round < rounds / 20 + 8; round++) {
+        values.push_back(random_number(random_size(max.size() + 20)));
+    }
+    const std::string name = "fixed_bigint<" + std::to_string(Bits) + "> ";
+    for (const auto &lhs : values) {
+        const std::string expected = (bigint(lhs) % modulus).to_string();
+        const fixed a(lhs);
+        expect(name + "from string", lhs, "", expected, a.to_string());
+        expect(
+            name + "from bigint", lhs, "", expected,
+            fixed(bigint(lhs)).to_string()
+        );
+        expect(name + "to bigint", lhs, "", expected, bigint(a).to_string());
+        for (const auto &rhs : values) {
+            const bigint x = bigint(lhs) % modulus;
+            const bigint y = bigint(rhs) % modulus;
+            const fixed b(rhs);
+            expect(
+                name + "+", lhs, rhs, ((x + y) % modulus).to_string(),
+                (a + b).to_string()
+            );
+            expect(
+                name + "-", lhs, rhs, ((x + modulus - y) % modulus).to_string(),
+                (a - b).to_string()
+            );
+            expect(
+                name + "*", lhs, rhs, ((x * y) % modulus).to_string(),
+                (a * b).to_string()
+            );
+            expect(
+                name + "<", lhs, rhs, x < y ? "1" : "0", a < b ? "1" : "0"
+            );
+            expect(
+                name + "==", lhs, rhs, x == y ? "1" : "0", a == b ? "1" : "0"
+            );
+        }
+    }
+}
+
+// fixed_bigint arithmetic, wraparound included, works in constant
+// expressions.
+constexpr uint256 FIXED_MAX = uint256(0U) - 1U;
+static_assert(FIXED_MAX + 1U == uint256());
+static_assert(FIXED_MAX * FIXED_MAX == uint256(1U));
+static_assert(uint256(65536U) * 65536U > uint256(~0U));
+static_assert(static_cast<unsigned>(uint256(65536U) * 65536U) == 0);
+
+// Operands of at least PARALLEL_THRESHOLD limbs, dense, sparse and powers
+// of ten, checked on the shared pool and on one with three workers.
+void check_parallel_products() {
+    const std::size_t digits =
+        3 * bigint_multiply::PARALLEL_THRESHOLD + 1000;
+    const std::vector<std::pair<std::string, std::string>> operands = {
+        {random_number(digits), random_number(digits)},
+        {sparse_number(digits), random_number(digits)},
+        {"1" + std::string(digits, '0'), random_number(digits)},
+        {random_number(digits / 2) + std::string(digits / 2, '0'),
+         random_number(digits / 3) + std::string(digits / 2, '0')}};
+    bigint_tasks::task_pool pool(3);
+    for (const auto &[lhs, rhs] : operands) {
+        const std::string expected = reference::multiply(lhs, rhs);
+        expect(
+            "* parallel", lhs, rhs, expected,
+            (bigint(lhs) * bigint(rhs)).to_string()
+        );
+        const bigint_tasks::use_pool use(pool);
+        expect(
+            "* parallel", lhs, rhs, expected,
+            (bigint(lhs) * bigint(rhs)).to_string()
+        );
+    }
+}
+
+// Computes lhs * rhs + lhs in an arena and returns the result out of it.
+bigint multiply_add_in_arena(const bigint &lhs, const bigint &rhs) {
+    bigint_arena::scope scope;
+    const bigint result = lhs * rhs + lhs;
+    return scope.keep(result);
+}
+
+// Results kept from a scope must survive it, also from inside another one.
+void check_arena(const std::string &lhs, const std::string &rhs) {
+    const std::string expected =
+        reference::add(reference::multiply(lhs, rhs), lhs);
+    const bigint kept = multiply_add_in_arena(bigint(lhs), bigint(rhs));
+    expect("arena keep", lhs, rhs, expected, kept.to_string());
+    bigint_arena::scope outer;
+    const bigint nested = multiply_add_in_arena(bigint(lhs), bigint(rhs));
+    expect("arena keep", lhs, rhs, expected, nested.to_string());
+}
+
+// Lengths that wrap around or exceed the data must be rejected, not
+// trusted, and so must encodings serialize() never produces: a length
+// whose last varint byte carries bits past 64, and a last word with
+// nonzero limbs beyond the length.
+void check_hostile_encodings() {
+    const std::vector<std::vector<unsigned char>> encodings = {
+        {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x01, 1, 2, 3},
+        {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x0F, 1, 2, 3, 4},
+        {0x00},
+        {0x04, 1, 2, 3, 4},
+        {0x81, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x80, 0x02, 5, 0, 0,
+         0},
+        {0x01, 0x05, 0x14, 0, 0}};
+    for (const auto &encoding : encodings) {
+        const std::string bytes(encoding.begin(), encoding.end());
+        std::string buffer_outcome = "accepted";
+        try {
+            const unsigned char *cursor = encoding.data();
+            bigint::deserialize(cursor, encoding.data() + encoding.size());
+        } catch (const std::invalid_argument &) {
+            buffer_outcome = "invalid_argument";
+        }
+        expect("deserialize", bytes, "", "invalid_argument", buffer_outcome);
+        std::string stream_outcome = "accepted";
+        try {
+            std::istringstream in(bytes);
+            bigint result;
+            bigint::deserialize(in, result);
+        } catch (const std::invalid_argument &) {
+            stream_outcome = "invalid_argument";
+        }
+        expect("deserialize", bytes, "", "invalid_argument", stream_outcome);
+    }
+}
+
+void fuzz(int rounds) {
+    check_hostile_encodings();
+    check_arena(random_number(200), random_number(150));
+    check_parallel_products();
+    check_fixed_width<256>(rounds);
+    check_fixed_width<96>(rounds);
+    const std::vector<std::string> edge_cases = {
+        "0", "1", "999", "1000", "999999", "1000000", "1000000000",
+        std::string(120, '9'), "1" + std::string(120, '0')};
+    for (const auto &lhs : edge_cases) {
+        for (const auto &rhs : edge_cases) {
+            check_pair(lhs, rhs);
+        }
+    }
+    for (int round = 0; round < rounds; round++) {
+        check_pair(
+            random_number(random_size(120)), random_number(random_size(120))
+        );
+    }
+    // Large enough for Karatsuba, small enough for the quadratic reference.
+    for (int round = 0; round < rounds / 50 + 1; round++) {
+        const std::string lhs = random_number(random_size(1200));
+        const std::string rhs = random_number(random_size(1200));
+        expect(
+            "*", lhs, rhs, reference::multiply(lhs, rhs),
+            (bigint(lhs) * bigint(rhs)).to_string()
+        );
+    }
+    // Sparse operands leave Karatsuba's middle product shorter than the
+    // products of the halves.
+    for (int round = 0; round < rounds / 50 + 1; round++) {
+        const std::string lhs = sparse_number(random_size(1200) + 150);
+        const std::string rhs = round % 2 == 0
+                                    ? sparse_number(random_size(1200) + 150)
+                                    : random_number(random_size(1200));
+        expect(
+            "*", lhs, rhs, reference::multiply(lhs, rhs),
+            (bigint(lhs) * bigint(rhs)).to_string()
+        );
+    }
+    for (int round = 0; round < rounds / 10 + 1; round++) {
+        const std::string base = random_number(random_size(30));
+        const std::string modulus = random_number(random_size(25));
+        const unsigned exponent = static_cast<unsigned>(generator()() % 500);
+        expect(
+            "pow_mod", base + "^" + std::to_string(exponent), modulus,
+            reference::pow_mod(base, exponent, modulus),
+            pow_mod(bigint(base), bigint(exponent), bigint(modulus)).to_string()
+        );
+    }
+}
+
+volatile std::size_t sink = 0;
+
+// Repeats the operation until at least min_time has passed and returns the
+// mean time of one call in nanoseconds.
+double time_per_call(const std::function<void()> &operation) {
+    using clock = std::chrono::steady_clock;
+    const auto min_time = std::chrono::milliseconds(200);
+    std::size_t calls = 0;
+    const auto start = clock::now();
+    auto elapsed = clock::duration::zero();
+    do {
+        operation();
+        calls++;
+        elapsed = clock::now() - start;
+    } while (elapsed < min_time);
+    return std::chrono::duration<double, std::nano>(elapsed).count() /
+           static_cast<double>(calls);
+}
+
+void report(const std::string &operation, std::size_t digits, double ns) {
+    std::cout << std::left << std::setw(12) << operation << std::right
+              << std::setw(10) << digits << std::setw(18) << std::fixed
+              << std::setprecision(1) << ns << "\n";
+}
+
+void benchmark(std::size_t max_digits) {
+    // Quadratic operations stop at smaller sizes so a run stays short.
+    const std::size_t max_divide_digits = 20000;
+    const std::size_t max_pow_mod_digits = 300;
+
+    std::cout << std::left << std::setw(12) << "operation" << std::right
+              << std::setw(10) << "digits" << std::setw(18) << "ns/op\n";
+    for (std::size_t digits = 3; digits <= max_digits; digits *= 10) {
+        const std::string lhs_string = random_number(digits);
+        const std::string rhs_string = random_number(digits);
+        const bigint lhs(lhs_string);
+        const bigint rhs(rhs_string);
+        const bigint &larger = lhs < rhs ? rhs : lhs;
+        const bigint &smaller = lhs < rhs ? lhs : rhs;
+
+        report("from_string", digits, time_per_call([&] {
+                   sink = sink + bigint(lhs_string).to_string().size();
+               }));
+        report("to_string", digits, time_per_call([&] {
+                   sink = sink + lhs.to_string().size();
+               }));
+        report("+", digits, time_per_call([&] {
+                   bigint sum = lhs + rhs;
+                   static_cast<void>(sum);
+               }));
+        report("a+b+a-b", digits, time_per_call([&] {
+                   bigint sum = lhs + rhs + lhs - rhs;
+                   static_cast<void>(sum);
+               }));
+        report("-", digits, time_per_call([&] {
+                   bigint difference = larger - smaller;
+                   static_cast<void>(difference);
+               }));
+        report("<", digits, time_per_call([&] {
+                   sink = sink + (lhs < rhs ? 1 : 0);
+               }));
+        report("==", digits, time_per_call([&] {
+                   sink = sink + (lhs == larger ? 1 : 0);
+               }));
+        report("*", digits, time_per_call([&] {
+                   bigint product = lhs * rhs;
+                   static_cast<void>(product);
+               }));
+        if (digits <= max_divide_digits) {
+            const bigint divisor(random_number(digits / 2 + 1));
+            report("/", digits, time_per_call([&] {
+                       bigint quotient = lhs / divisor;
+                       static_cast<void>(quotient);
+                   }));
+            report("%", digits, time_per_call([&] {
+                       bigint remainder = lhs % divisor;
+                       static_cast<void>(remainder);
+                   }));
+        }
+        if (digits <= max_pow_mod_digits) {
+            bigint modulus(random_number(digits));
+            while (!montgomery_context::supports(modulus)) {
+                modulus += bigint(1);
+            }
+            const montgomery_context context(modulus);
+            report("pow_mod", digits, time_per_call([&] {
+                       bigint power = context.pow(lhs, rhs);
+                       static_cast<void>(power);
+                   }));
+        }
+        if (digits < max_digits && digits * 10 > max_digits) {
+            digits = max_digits / 10;
+        }
+    }
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t max_digits =
+        argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const int fuzz_rounds = argc > 2 ? std::atoi(argv[2]) : 2000;
+    generator().seed(argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 2024);
+
+    fuzz(fuzz_rounds);
+    if (mismatches != 0) {
+        std::cout << mismatches << " mismatch(es) against the reference\n";
+        return 1;
+    }
+    std::cout << "Differential check passed (" << fuzz_rounds
+              << " random rounds)\n\n";
+    benchmark(max_digits);
+    return 0;
+}
@@ -0,0 +1,227 @@
+#ifndef BIGINT_MULTIPLY_HPP_
+#define BIGINT_MULTIPLY_HPP_
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include <vector>
+#include "bigint_task_pool.hpp"
+
+// Limb multiplication for bigint. Limbs are little-endian digits in
+// [0, base). Small operands use the schoolbook method, larger ones
+// Karatsuba. Once the longer operand reaches PARALLEL_THRESHOLD limbs the
+// three Karatsuba subproducts are computed as tasks on the shared
+// work-stealing pool; below it everything stays on the calling thread. The
+// split points do not depend on the number of threads, so results are the
+// same either way.
+namespace bigint_multiply {
+
+constexpr std::size_t KARATSUBA_THRESHOLD = 48;
+constexpr std::size_t PARALLEL_THRESHOLD = 4096;
+
+// result[0, lhs_size + rhs_size) must be zero on entry.
+inline void multiply(
+    const unsigned *lhs,
+    std::size_t lhs_size,
+    const unsigned *rhs,
+    std::size_t rhs_size,
+    unsigned *result,
+    unsigned base
+);
+
+namespace detail {
+inline std::size_t significant_size(const unsigned *limbs, std::size_t size) {
+    while (size > 0 && limbs[size - 1] == 0) {
+        size--;
+    }
+    return size;
+}
+
+// result[0, lhs_size + rhs_size) must be zero on entry.
+inline void schoolbook(
+    const unsigned *lhs,
+    std::size_t lhs_size,
+    const unsigned *rhs,
+    std::size_t rhs_size,
+    unsigned *result,
+    unsigned base
+) {
+    for (std::size_t i = 0; i < lhs_size; i++) {
+        if (lhs[i] == 0) {
+            continue;
+        }
+        unsigned long long carry = 0;
+        for (std::size_t j = 0; j < rhs_size; j++) {
+            unsigned long long current =
+                result[i + j] +
+                static_cast<unsigned long long>(lhs[i]) * rhs[j] + carry;
+            result[i + j] = static_cast<unsigned>(current % base);
+            carry = current / base;
+        }
+        result[i + rhs_size] = static_cast<unsigned>(carry);
+    }
+}
+
+// target[0, target_size) += source[0, source_size); the sum must fit.
+inline void add_into(
+    unsigned *target,
+    std::size_t target_size,
+    const unsigned *source,
+    std::size_t source_size,
+    unsigned base
+) {
+    unsigned carry = 0;
+    std::size_t i = 0;
+    for (; i < source_size; i++) {
+        unsigned sum = target[i] + source[i] + carry;
+        carry = sum >= base ? 1 : 0;
+        target[i] = sum - carry * base;
+    }
+    for (; carry != 0 && i < target_size; i++) {
+        unsigned sum = target[i] + carry;
+        carry = sum >= base ? 1 : 0;
+        target[i] = sum - carry * base;
+    }
+}
+
+// target[0, target_size) -= source[0, source_size); the difference must be
+// non-negative.
+inline void subtract_from(
+    unsigned *target,
+    std::size_t target_size,
+    const unsigned *source,
+    std::size_t source_size,
+    unsigned base
+) {
+    unsigned borrow = 0;
+    std::size_t i = 0;
+    for (; i < source_size; i++) {
+        unsigned subtrahend = source[i] + borrow;
+        borrow = target[i] < subtrahend ? 1 : 0;
+        target[i] = target[i] + borrow * base - subtrahend;
+    }
+    for (; borrow != 0 && i < target_size; i++) {
+        unsigned next_borrow = target[i] < borrow ? 1 : 0;
+        target[i] = target[i] + next_borrow * base - borrow;
+        borrow = next_borrow;
+    }
+}
+
+// limbs[0, split) + limbs[split, size) without leading zero limbs.
+inline std::vector<unsigned> halves_sum(
+    const unsigned *limbs,
+    std::size_t size,
+    std::size_t split,
+    unsigned base
+) {
+    const std::size_t low_size = std::min(size, split);
+    const std::size_t high_size = size - low_size;
+    std::vector<unsigned> sum(std::max(low_size, high_size) + 1, 0);
+    std::copy(limbs, limbs + low_size, sum.begin());
+    add_into(sum.data(), sum.size(), limbs + low_size, high_size, base);
+    const std::size_t significant = significant_size(sum.data(), sum.size());
+    sum.resize(std::max<std::size_t>(significant, 1));
+    return sum;
+}
+
+// lhs_size >= rhs_size > lhs_size / 2.
+inline void karatsuba(
+    const unsigned *lhs,
+    std::size_t lhs_size,
+    const unsigned *rhs,
+    std::size_t rhs_size,
+    unsigned *result,
+    unsigned base
+) {
+    const std::size_t split = lhs_size / 2;
+    const std::size_t result_size = lhs_size + rhs_size;
+
+    // result = z2 * base^(2 split) + z0, z1 is added in the middle below.
+    unsigned *low_product = result;
+    unsigned *high_product = result + 2 * split;
+    std::vector<unsigned> lhs_sum = halves_sum(lhs, lhs_size, split, base);
+    std::vector<unsigned> rhs_sum = halves_sum(rhs, rhs_size, split, base);
+    std::vector<unsigned> middle(lhs_sum.size() + rhs_sum.size(), 0);
+
+    auto low = [&] {
+        multiply(lhs, split, rhs, split, low_product, base);
+    };
+    auto high = [&] {
+        multiply(
+            lhs + split, lhs_size - split, rhs + split, rhs_size - split,
+            high_product, base
+        );
+    };
+    auto mixed = [&] {
+        multiply(
+            lhs_sum.data(), lhs_sum.size(), rhs_sum.data(), rhs_sum.size(),
+            middle.data(), base
+        );
+    };
+    if (lhs_size >= PARALLEL_THRESHOLD) {
+        bigint_tasks::task_pool::current().invoke(mixed, low, high);
+    } else {
+        low();
+        high();
+        mixed();
+    }
+
+    // z0 and z2 never exceed z1, but their buffers may be longer than
+    // middle when an operand has many zero limbs, so only their significant
+    // limbs are subtracted.
+    subtract_from(
+        middle.data(), middle.size(), low_product,
+        significant_size(low_product, 2 * split), base
+    );
+    subtract_from(
+        middle.data(), middle.size(), high_product,
+        significant_size(high_product, result_size - 2 * split), base
+    );
+    add_into(
+        result + split, result_size - split, middle.data(),
+        significant_size(middle.data(), middle.size()), base
+    );
+}
+}  // namespace detail
+
+inline void multiply(
+    const unsigned *lhs,
+    std::size_t lhs_size,
+    const unsigned *rhs,
+    std::size_t rhs_size,
+    unsigned *result,
+    unsigned base
+) {
+    lhs_size = detail::significant_size(lhs, lhs_size);
+    rhs_size = detail::significant_size(rhs, rhs_size);
+    if (lhs_size < rhs_size) {
+        std::swap(lhs, rhs);
+        std::swap(lhs_size, rhs_size);
+    }
+    if (rhs_size < KARATSUBA_THRESHOLD) {
+        detail::schoolbook(lhs, lhs_size, rhs, rhs_size, result, base);
+        return;
+    }
+    if (2 * rhs_size > lhs_size) {
+        detail::karatsuba(lhs, lhs_size, rhs, rhs_size, result, base);
+        return;
+    }
+
+    // Unbalanced operands: multiply rhs by rhs_size-long slices of lhs.
+    std::vector<unsigned> slice_product(2 * rhs_size);
+    for (std::size_t offset = 0; offset < lhs_size; offset += rhs_size) {
+        const std::size_t slice_size = std::min(rhs_size, lhs_size - offset);
+        std::fill(slice_product.begin(), slice_product.end(), 0);
+        multiply(
+            lhs + offset, slice_size, rhs, rhs_size, slice_product.data(), base
+        );
+        detail::add_into(
+            result + offset, lhs_size + rhs_size - offset,
+            slice_product.data(), slice_size + rhs_size, base
+        );
+    }
+}
+
+}  // namespace bigint_multiply
+
+#endif  // BIGINT_MULTIPLY_HPP_
@@ -0,0 +1,342 @@
+#ifndef BIGINT_SIMD_HPP_
+#define BIGINT_SIMD_HPP_
+
+#include <cstddef>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BIGINT_SIMD_SSE2
+#endif
+
+#if defined(BIGINT_SIMD_SSE2) && defined(__GNUC__)
+#include <immintrin.h>
+#define BIGINT_SIMD_AVX2
+#endif
+
+// Limb kernels shared by the bigint comparison and addition operators. Limbs
+// are little-endian digits in [0, base).
+//
+// Carry propagation is vectorized with the generate/propagate trick: a lane
+// generates a carry when its raw sum is at least base and propagates an
+// incoming one when its raw sum is exactly base - 1. With G and P as lane
+// bitmasks, bit i of ((G << 1 | carry_in) + P) ^ P is the carry into lane i,
+// and the bit past the last lane is the carry out. Subtraction is the same
+// with borrows.
+namespace bigint_simd {
+
+struct kernels {
+    // Number of limbs below and including the highest differing one, or 0
+    // when the two ranges are equal.
+    std::size_t (*highest_difference)(
+        const unsigned *lhs,
+        const unsigned *rhs,
+        std::size_t size
+    );
+
+    // result = lhs + rhs + carry over size limbs, returns the outgoing carry.
+    unsigned (*add)(
+        const unsigned *lhs,
+        const unsigned *rhs,
+        unsigned *result,
+        std::size_t size,
+        unsigned base,
+        unsigned carry
+    );
+
+    // result = lhs - rhs - borrow over size limbs, returns the outgoing
+    // borrow.
+    unsigned (*subtract)(
+        const unsigned *lhs,
+        const unsigned *rhs,
+        unsigned *result,
+        std::size_t size,
+        unsigned base,
+        unsigned borrow
+    );
+};
+
+namespace scalar {
+inline std::size_t highest_difference(
+    const unsigned *lhs,
+    const unsigned *rhs,
+    std::size_t size
+) {
+    for (std::size_t i = size; i > 0; i--) {
+        if (lhs[i - 1] != rhs[i - 1]) {
+            return i;
+        }
+    }
+    return 0;
+}
+
+inline unsigned add(
+    const unsigned *lhs,
+    const unsigned *rhs,
+    unsigned *result,
+    std::size_t size,
+    unsigned base,
+    unsigned carry
+) {
+    for (std::size_t i = 0; i < size; i++) {
+        unsigned sum = lhs[i] + rhs[i] + carry;
+        carry = sum >= base ? 1 : 0;
+        result[i] = sum - carry * base;
+    }
+    return carry;
+}
+
+inline unsigned subtract(
+    const unsigned *lhs,
+    const unsigned *rhs,
+    unsigned *result,
+    std::size_t size,
+    unsigned base,
+    unsigned borrow
+) {
+    for (std::size_t i = 0; i < size; i++) {
+        unsigned subtrahend = rhs[i] + borrow;
+        borrow = lhs[i] < subtrahend ? 1 : 0;
+        result[i] = lhs[i] + borrow * base - subtrahend;
+    }
+    return borrow;
+}
+}  // namespace scalar
+
+#ifdef BIGINT_SIMD_SSE2
+namespace sse2 {
+constexpr std::size_t LANES = 4;
+
+inline unsigned lane_mask(__m128i mask) {
+    return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(mask)));
+}
+
+inline __m128i expand_mask(unsigned mask) {
+    const __m128i bits = _mm_setr_epi32(1, 2, 4, 8);
+    return _mm_cmpeq_epi32(
+        _mm_and_si128(_mm_set1_epi32(static_cast<int>(mask)), bits), bits
+    );
+}
+
+inline std::size_t highest_difference(
+    const unsigned *lhs,
+    const unsigned *rhs,
+    std::size_t size
+) {
+    std::size_t i = size;
+    for (; i >= LANES; i -= LANES) {
+        const __m128i left = _mm_loadu_si128(
+            reinterpret_cast<const __m128i *>(lhs + i - LANES)
+        );
+        const __m128i right = _mm_loadu_si128(
+            reinterpret_cast<const __m128i *>(rhs + i - LANES)
+        );
+        const unsigned equal = lane_mask(_mm_cmpeq_epi32(left, right));
+        if (equal != 0xF) {
+            unsigned lane = LANES - 1;
+            while ((equal >> lane) & 1U) {
+                lane--;
+            }
+            return i - LANES + lane + 1;
+        }
+    }
+    return scalar::highest_difference(lhs, rhs, i);
+}
+
+inline unsigned add(
+    const unsigned *lhs,
+    const unsigned *rhs,
+    unsigned *result,
+    std::size_t size,
+    unsigned base,
+    unsigned carry
+) {
+    const __m128i base_vector = _mm_set1_epi32(static_cast<int>(base));
+    const __m128i top = _mm_set1_epi32(static_cast<int>(base - 1));
+    std::size_t i = 0;
+    for (; i + LANES <= size; i += LANES) {
+        __m128i sum = _mm_add_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs + i)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs + i))
+        );
+        const unsigned generate = lane_mask(_mm_cmpgt_epi32(sum, top));
+        const unsigned propagate = lane_mask(_mm_cmpeq_epi32(sum, top));
+        const unsigned carries =
+            (((generate << 1) | carry) + propagate) ^ propagate;
+        sum = _mm_sub_epi32(sum, expand_mask(carries));
+        sum = _mm_sub_epi32(
+            sum, _mm_and_si128(_mm_cmpgt_epi32(sum, top), base_vector)
+        );
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(result + i), sum);
+        carry = (carries >> LANES) & 1U;
+    }
+    return scalar::add(lhs + i, rhs + i, result + i, size - i, base, carry);
+}
+
+inline unsigned subtract(
+    const unsigned *lhs,
+    const unsigned *rhs,
+    unsigned *result,
+    std::size_t size,
+    unsigned base,
+    unsigned borrow
+) {
+    const __m128i base_vector = _mm_set1_epi32(static_cast<int>(base));
+    const __m128i zero = _mm_setzero_si128();
+    std::size_t i = 0;
+    for (; i + LANES <= size; i += LANES) {
+        __m128i difference = _mm_sub_epi32(
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(lhs + i)),
+            _mm_loadu_si128(reinterpret_cast<const __m128i *>(rhs + i))
+        );
+        const unsigned generate =
+            lane_mask(_mm_cmplt_epi32(difference, zero));
+        const unsigned propagate =
+            lane_mask(_mm_cmpeq_epi32(difference, zero));
+        const unsigned borrows =
+            (((generate << 1) | borrow) + propagate) ^ propagate;
+        difference = _mm_add_epi32(difference, expand_mask(borrows));
+        difference = _mm_add_epi32(
+            difference,
+            _mm_and_si128(_mm_cmplt_epi32(difference, zero), base_vector)
+        );
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(result + i), difference);
+        borrow = (borrows >> LANES) & 1U;
+    }
+    return scalar::subtract(
+        lhs + i, rhs + i, result + i, size - i, base, borrow
+    );
+}
+}  // namespace sse2
+#endif  // BIGINT_SIMD_SSE2
+
+#ifdef BIGINT_SIMD_AVX2
+namespace avx2 {
+constexpr std::size_t LANES = 8;
+
+__attribute__((target("avx2"))) inline unsigned lane_mask(__m256i mask) {
+    return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(mask))
+    );
+}
+
+__attribute__((target("avx2"))) inline __m256i expand_mask(unsigned mask) {
+    const __m256i bits = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    return _mm256_cmpeq_epi32(
+        _mm256_and_si256(_mm256_set1_epi32(static_cast<int>(mask)), bits),
+        bits
+    );
+}
+
+__attribute__((target("avx2"))) inline std::size_t highest_difference(
+    const unsigned *lhs,
+    const unsigned *rhs,
+    std::size_t size
+) {
+    std::size_t i = size;
+    for (; i >= LANES; i -= LANES) {
+        const __m256i left = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(lhs + i - LANES)
+        );
+        const __m256i right = _mm256_loadu_si256(
+            reinterpret_cast<const __m256i *>(rhs + i - LANES)
+        );
+        const unsigned equal = lane_mask(_mm256_cmpeq_epi32(left, right));
+        if (equal != 0xFF) {
+            const unsigned different = ~equal & 0xFFU;
+            return i - LANES +
+                   static_cast<std::size_t>(32 - __builtin_clz(different));
+        }
+    }
+    return sse2::highest_difference(lhs, rhs, i);
+}
+
+__attribute__((target("avx2"))) inline unsigned add(
+    const unsigned *lhs,
+    const unsigned *rhs,
+    unsigned *result,
+    std::size_t size,
+    unsigned base,
+    unsigned carry
+) {
+    const __m256i base_vector = _mm256_set1_epi32(static_cast<int>(base));
+    const __m256i top = _mm256_set1_epi32(static_cast<int>(base - 1));
+    std::size_t i = 0;
+    for (; i + LANES <= size; i += LANES) {
+        __m256i sum = _mm256_add_epi32(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + i)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + i))
+        );
+        const unsigned generate = lane_mask(_mm256_cmpgt_epi32(sum, top));
+        const unsigned propagate = lane_mask(_mm256_cmpeq_epi32(sum, top));
+        const unsigned carries =
+            (((generate << 1) | carry) + propagate) ^ propagate;
+        sum = _mm256_sub_epi32(sum, expand_mask(carries));
+        sum = _mm256_sub_epi32(
+            sum, _mm256_and_si256(_mm256_cmpgt_epi32(sum, top), base_vector)
+        );
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(result + i), sum);
+        carry = (carries >> LANES) & 1U;
+    }
+    return sse2::add(lhs + i, rhs + i, result + i, size - i, base, carry);
+}
+
+__attribute__((target("avx2"))) inline unsigned subtract(
+    const unsigned *lhs,
+    const unsigned *rhs,
+    unsigned *result,
+    std::size_t size,
+    unsigned base,
+    unsigned borrow
+) {
+    const __m256i base_vector = _mm256_set1_epi32(static_cast<int>(base));
+    const __m256i zero = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + LANES <= size; i += LANES) {
+        __m256i difference = _mm256_sub_epi32(
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(lhs + i)),
+            _mm256_loadu_si256(reinterpret_cast<const __m256i *>(rhs + i))
+        );
+        const unsigned generate =
+            lane_mask(_mm256_cmpgt_epi32(zero, difference));
+        const unsigned propagate =
+            lane_mask(_mm256_cmpeq_epi32(difference, zero));
+        const unsigned borrows =
+            (((generate << 1) | borrow) + propagate) ^ propagate;
+        difference = _mm256_add_epi32(difference, expand_mask(borrows));
+        difference = _mm256_add_epi32(
+            difference,
+            _mm256_and_si256(_mm256_cmpgt_epi32(zero, difference), base_vector)
+        );
+        _mm256_storeu_si256(
+            reinterpret_cast<__m256i *>(result + i), difference
+        );
+        borrow = (borrows >> LANES) & 1U;
+    }
+    return sse2::subtract(
+        lhs + i, rhs + i, result + i, size - i, base, borrow
+    );
+}
+}  // namespace avx2
+#endif  // BIGINT_SIMD_AVX2
+
+// Picks the widest kernels the running CPU supports, once per process.
+inline const kernels &active() {
+    static const kernels selected = [] {
+#ifdef BIGINT_SIMD_AVX2
+        if (__builtin_cpu_supports("avx2")) {
+            return kernels{
+                avx2::highest_difference, avx2::add, avx2::subtract};
+        }
+#endif
+#ifdef BIGINT_SIMD_SSE2
+        return kernels{sse2::highest_difference, sse2::add, sse2::subtract};
+#else
+        return kernels{
+            scalar::highest_difference, scalar::add, scalar::subtract};
+#endif
+    }();
+    return selected;
+}
+
+}  // namespace bigint_simd
+
+#endif  // BIGINT_SIMD_HPP_
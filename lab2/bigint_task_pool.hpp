@@ -0,0 +1,241 @@
+#ifndef BIGINT_TASK_POOL_HPP_
+#define BIGINT_TASK_POOL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool for fork-join recursion such as parallel Karatsuba.
+// Every worker owns a deque: it pushes and pops forked tasks at the back and
+// idle workers steal from the front, so the oldest and largest subproblems
+// migrate. Threads outside the pool fork into a shared injection deque. A
+// forking thread never blocks while its children run: it keeps executing
+// pending tasks until they are done, so nested invoke() calls cannot
+// deadlock even with a single worker.
+namespace bigint_tasks {
+
+class task_pool {
+    struct task {
+        std::function<void()> function;
+        std::atomic<bool> done{false};
+        std::exception_ptr error;
+    };
+
+    struct task_deque {
+        std::mutex mutex;
+        std::deque<task *> tasks;
+    };
+
+    std::vector<std::thread> workers;
+    // One deque per worker plus the injection deque at the end.
+    std::vector<std::unique_ptr<task_deque>> deques;
+    std::mutex sleep_mutex;
+    std::condition_variable wake_up;
+    std::atomic<std::size_t> pending{0};
+    std::atomic<bool> stopping{false};
+
+    static int &current_worker() {
+        thread_local int index = -1;
+        return index;
+    }
+
+    [[nodiscard]] std::size_t own_deque() const {
+        const int index = current_worker();
+        return index < 0 ? deques.size() - 1 : static_cast<std::size_t>(index);
+    }
+
+    void push(task *new_task) {
+        task_deque &deque = *deques[own_deque()];
+        pending.fetch_add(1, std::memory_order_release);
+        {
+            std::lock_guard<std::mutex> lock(deque.mutex);
+            deque.tasks.push_back(new_task);
+        }
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+        }
+        wake_up.notify_one();
+    }
+
+    task *pop_or_steal() {
+        const std::size_t own = own_deque();
+        {
+            task_deque &deque = *deques[own];
+            std::lock_guard<std::mutex> lock(deque.mutex);
+            if (!deque.tasks.empty()) {
+                task *result = deque.tasks.back();
+                deque.tasks.pop_back();
+                pending.fetch_sub(1, std::memory_order_relaxed);
+                return result;
+            }
+        }
+        for (std::size_t step = 1; step < deques.size(); step++) {
+            task_deque &victim = *deques[(own + step) % deques.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task *result = victim.tasks.front();
+                victim.tasks.pop_front();
+                pending.fetch_sub(1, std::memory_order_relaxed);
+                return result;
+            }
+        }
+        return nullptr;
+    }
+
+    static void run(task *current) {
+        try {
+            current->function();
+        } catch (...) {
+            current->error = std::current_exception();
+        }
+        current->done.store(true, std::memory_order_release);
+    }
+
+    void worker_loop(int index) {
+        current_worker() = index;
+        while (true) {
+            if (task *next = pop_or_steal()) {
+                run(next);
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            wake_up.wait(lock, [this] {
+                return stopping.load() || pending.load() != 0;
+            });
+            if (stopping.load()) {
+                return;
+            }
+        }
+    }
+
+public:
+    explicit task_pool(std::size_t num_workers) {
+        for (std::size_t i = 0; i <= num_workers; i++) {
+            deques.push_back(std::make_unique<task_deque>());
+        }
+        for (std::size_t i = 0; i < num_workers; i++) {
+            workers.emplace_back([this, i] {
+                worker_loop(static_cast<int>(i));
+            });
+        }
+    }
+
+    task_pool(const task_pool &) = delete;
+
+    task_pool(task_pool &&) = delete;
+
+    task_pool &operator=(const task_pool &) = delete;
+
+    task_pool &operator=(task_pool &&) = delete;
+
+    ~task_pool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stopping.store(true);
+        }
+        wake_up.notify_all();
+        for (auto &worker : workers) {
+            worker.join();
+        }
+    }
+
+    // Shared pool with one worker per hardware thread besides the caller.
+    static task_pool &instance() {
+        static task_pool pool(
+            std::max(std::thread::hardware_concurrency(), 1U) - 1
+        );
+        return pool;
+    }
+
+    // Pool installed by use_pool, if any.
+    static std::atomic<task_pool *> &replacement() {
+        static std::atomic<task_pool *> pool{nullptr};
+        return pool;
+    }
+
+    // The pool bigint forks into: instance() unless a use_pool is alive.
+    static task_pool &current() {
+        task_pool *pool = replacement().load(std::memory_order_acquire);
+        return pool != nullptr ? *pool : instance();
+    }
+
+    [[nodiscard]] std::size_t size() const {
+        return workers.size();
+    }
+
+    // Runs all functions, possibly in parallel, and returns once every one
+    // of them has finished. The first exception thrown is rethrown.
+    template <typename First, typename... Rest>
+    void invoke(First &&first, Rest &&...rest) {
+        if (sizeof...(Rest) == 0 || workers.empty()) {
+            first();
+            (rest(), ...);
+            return;
+        }
+        task forked[std::max<std::size_t>(sizeof...(Rest), 1)];
+        std::size_t index = 0;
+        ((forked[index++].function = std::forward<Rest>(rest)), ...);
+        for (std::size_t i = sizeof...(Rest); i > 0; i--) {
+            push(&forked[i - 1]);
+        }
+
+        std::exception_ptr error;
+        try {
+            first();
+        } catch (...) {
+            error = std::current_exception();
+        }
+        for (std::size_t i = 0; i < sizeof...(Rest); i++) {
+            task &child = forked[i];
+            while (!child.done.load(std::memory_order_acquire)) {
+                if (task *next = pop_or_steal()) {
+                    run(next);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+            if (error == nullptr && child.error != nullptr) {
+                error = child.error;
+            }
+        }
+        if (error != nullptr) {
+            std::rethrow_exception(error);
+        }
+    }
+};
+
+// Makes every thread fork into `pool` instead of the shared one while
+// alive, e.g. to exercise the parallel paths on a machine with few hardware
+// threads. Must not be created or destroyed while a computation runs.
+struct use_pool {
+    explicit use_pool(task_pool &pool)
+        : previous(task_pool::replacement().exchange(&pool)) {
+    }
+
+    use_pool(const use_pool &) = delete;
+
+    use_pool(use_pool &&) = delete;
+
+    use_pool &operator=(const use_pool &) = delete;
+
+    use_pool &operator=(use_pool &&) = delete;
+
+    ~use_pool() {
+        task_pool::replacement().store(previous);
+    }
+
+private:
+    task_pool *previous;
+};
+
+}  // namespace bigint_tasks
+
+#endif  // BIGINT_TASK_POOL_HPP_
@@ -0,0 +1,250 @@
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include "bigint.inc.cpp"
+
+// Unsigned integer of exactly Bits bits with the bigint interface, for
+// workloads whose width is known up front (256, 512, 1024 bits...). Limbs
+// are 32-bit words in a std::array, so values never touch the heap, and the
+// carry chains of +, - and comparisons are unrolled at compile time. Like the
+// built-in unsigned types, arithmetic wraps around modulo 2^Bits.
+template <std::size_t Bits>
+struct fixed_bigint {
+    static_assert(Bits > 0 && Bits % 32 == 0, "Bits must be a multiple of 32");
+
+    static constexpr std::size_t LIMBS = Bits / 32;
+
+private:
+    using limb = std::uint32_t;
+    using wide_limb = std::uint64_t;
+    using indices = std::make_index_sequence<LIMBS>;
+
+    // Decimal digits are converted nine at a time. Every chunk divides the
+    // value by more than 2^29, which bounds how many there can be.
+    static constexpr limb DECIMAL_CHUNK = 1000000000;
+    static constexpr std::size_t DECIMAL_CHUNK_DIGITS = 9;
+    static constexpr std::size_t MAX_DECIMAL_CHUNKS = (Bits + 28) / 29;
+
+    // Base 10^9 chunks of the value, least significant first.
+    struct decimal_chunks {
+        std::array<limb, MAX_DECIMAL_CHUNKS> values{};
+        std::size_t count = 0;
+    };
+
+    std::array<limb, LIMBS> limbs{};
+
+    template <std::size_t... I>
+    constexpr void
+    add_limbs(const fixed_bigint &other, std::index_sequence<I...>) {
+        wide_limb carry = 0;
+        ((carry += static_cast<wide_limb>(limbs[I]) + other.limbs[I],
+          limbs[I] = static_cast<limb>(carry), carry >>= 32),
+         ...);
+    }
+
+    template <std::size_t... I>
+    constexpr void
+    subtract_limbs(const fixed_bigint &other, std::index_sequence<I...>) {
+        wide_limb borrow = 0;
+        ((borrow = static_cast<wide_limb>(limbs[I]) - other.limbs[I] - borrow,
+          limbs[I] = static_cast<limb>(borrow), borrow = (borrow >> 32) & 1U),
+         ...);
+    }
+
+    template <std::size_t... I>
+    [[nodiscard]] constexpr bool
+    equal_limbs(const fixed_bigint &other, std::index_sequence<I...>) const {
+        return ((limbs[I] == other.limbs[I]) && ...);
+    }
+
+    // Walks the limbs from the most significant one and stops at the first
+    // difference.
+    template <std::size_t... I>
+    [[nodiscard]] constexpr bool
+    less_limbs(const fixed_bigint &other, std::index_sequence<I...>) const {
+        bool less = false;
+        static_cast<void>(
+            ((limbs[LIMBS - 1 - I] != other.limbs[LIMBS - 1 - I] &&
+              (less = limbs[LIMBS - 1 - I] < other.limbs[LIMBS - 1 - I],
+               true)) ||
+             ...)
+        );
+        return less;
+    }
+
+    constexpr void multiply_add_small(limb factor, limb addend) {
+        wide_limb carry = addend;
+        for (std::size_t i = 0; i < LIMBS; i++) {
+            carry += static_cast<wide_limb>(limbs[i]) * factor;
+            limbs[i] = static_cast<limb>(carry);
+            carry >>= 32;
+        }
+    }
+
+    // Divides in place and returns the remainder.
+    constexpr limb divide_small(limb divisor) {
+        wide_limb remainder = 0;
+        for (std::size_t i = LIMBS; i > 0; i--) {
+            wide_limb current = (remainder << 32) | limbs[i - 1];
+            limbs[i - 1] = static_cast<limb>(current / divisor);
+            remainder = current % divisor;
+        }
+        return static_cast<limb>(remainder);
+    }
+
+    [[nodiscard]] constexpr bool is_zero() const {
+        return *this == fixed_bigint();
+    }
+
+    [[nodiscard]] constexpr decimal_chunks to_decimal_chunks() const {
+        decimal_chunks chunks;
+        fixed_bigint current = *this;
+        do {
+            chunks.values[chunks.count++] = current.divide_small(DECIMAL_CHUNK);
+        } while (!current.is_zero());
+        return chunks;
+    }
+
+public:
+    constexpr fixed_bigint() = default;
+
+    // cppcheck-suppress noExplicitConstructor
+    constexpr fixed_bigint(unsigned number) {
+        limbs[0] = number;
+    }
+
+    explicit fixed_bigint(const std::string &string) {
+        std::size_t first = string.size() % DECIMAL_CHUNK_DIGITS;
+        if (first == 0) {
+            first = DECIMAL_CHUNK_DIGITS;
+        }
+        for (std::size_t i = 0; i < string.size();) {
+            std::size_t length = i == 0 ? first : DECIMAL_CHUNK_DIGITS;
+            multiply_add_small(
+                DECIMAL_CHUNK,
+                static_cast<limb>(std::stoul(string.substr(i, length)))
+            );
+            i += length;
+        }
+    }
+
+    explicit fixed_bigint(const bigint &number) {
+        for (std::size_t i = number.digits.size(); i > 0; i--) {
+            multiply_add_small(BASE, number.digits[i - 1]);
+        }
+    }
+
+    explicit operator bigint() const {
+        decimal_chunks chunks = to_decimal_chunks();
+        bigint result(bigint::uninitialized_tag{}, 3 * chunks.count);
+        for (std::size_t i = 0; i < chunks.count; i++) {
+            for (std::size_t j = 0; j < 3; j++) {
+                result.digits[3 * i + j] = chunks.values[i] % BASE;
+                chunks.values[i] /= BASE;
+            }
+        }
+        result.delete_leading_zeros_from_bigint();
+        return result;
+    }
+
+    explicit constexpr operator unsigned int() const {
+        return limbs[0];
+    }
+
+    // The digits are laid out in a local buffer; only the returned string
+    // allocates.
+    [[nodiscard]] std::string to_string() const {
+        decimal_chunks chunks = to_decimal_chunks();
+        std::array<char, MAX_DECIMAL_CHUNKS * DECIMAL_CHUNK_DIGITS> text{};
+        std::size_t first = text.size();
+        for (std::size_t i = 0; i < chunks.count; i++) {
+            for (std::size_t j = 0; j < DECIMAL_CHUNK_DIGITS; j++) {
+                text[--first] = static_cast<char>('0' + chunks.values[i] % 10);
+                chunks.values[i] /= 10;
+            }
+        }
+        while (first + 1 < text.size() && text[first] == '0') {
+            first++;
+        }
+        return std::string(text.data() + first, text.size() - first);
+    }
+
+    friend constexpr bool
+    operator==(const fixed_bigint &lhs, const fixed_bigint &rhs) {
+        return lhs.equal_limbs(rhs, indices{});
+    }
+
+    friend constexpr bool
+    operator!=(const fixed_bigint &lhs, const fixed_bigint &rhs) {
+        return !(lhs == rhs);
+    }
+
+    friend constexpr bool
+    operator<(const fixed_bigint &lhs, const fixed_bigint &rhs) {
+        return lhs.less_limbs(rhs, indices{});
+    }
+
+    friend constexpr bool
+    operator>(const fixed_bigint &lhs, const fixed_bigint &rhs) {
+        return rhs < lhs;
+    }
+
+    friend constexpr bool
+    operator<=(const fixed_bigint &lhs, const fixed_bigint &rhs) {
+        return !(rhs < lhs);
+    }
+
+    friend constexpr bool
+    operator>=(const fixed_bigint &lhs, const fixed_bigint &rhs) {
+        return !(lhs < rhs);
+    }
+
+    friend constexpr fixed_bigint &
+    operator+=(fixed_bigint &lhs, const fixed_bigint &rhs) {
+        lhs.add_limbs(rhs, indices{});
+        return lhs;
+    }
+
+    friend constexpr fixed_bigint
+    operator+(fixed_bigint lhs, const fixed_bigint &rhs) {
+        return lhs += rhs;
+    }
+
+    friend constexpr fixed_bigint &
+    operator-=(fixed_bigint &lhs, const fixed_bigint &rhs) {
+        lhs.subtract_limbs(rhs, indices{});
+        return lhs;
+    }
+
+    friend constexpr fixed_bigint
+    operator-(fixed_bigint lhs, const fixed_bigint &rhs) {
+        return lhs -= rhs;
+    }
+
+    // Schoolbook product truncated to the low Bits bits.
+    friend constexpr fixed_bigint
+    operator*(const fixed_bigint &lhs, const fixed_bigint &rhs) {
+        fixed_bigint result;
+        for (std::size_t i = 0; i < LIMBS; i++) {
+            wide_limb carry = 0;
+            for (std::size_t j = 0; i + j < LIMBS; j++) {
+                carry += static_cast<wide_limb>(lhs.limbs[i]) * rhs.limbs[j] +
+                         result.limbs[i + j];
+                result.limbs[i + j] = static_cast<limb>(carry);
+                carry >>= 32;
+            }
+        }
+        return result;
+    }
+
+    friend constexpr fixed_bigint &
+    operator*=(fixed_bigint &lhs, const fixed_bigint &rhs) {
+        return lhs = lhs * rhs;
+    }
+};
+
+using uint256 = fixed_bigint<256>;
+using uint512 = fixed_bigint<512>;
+using uint1024 = fixed_bigint<1024>;
@@ -8,4 +8,27 @@ widget *widget::child_at(int x, int y) {
         return nullptr;
     }
 }
+
+void widget::size_changed() {
+    if (m_parent != nullptr) {
+        m_parent->mark_dirty();
+    }
+}
+
+void container::mark_dirty() {
+    for (container *current = this;
+         current != nullptr && !current->layout_dirty;
+         current = current->parent()) {
+        current->layout_dirty = true;
+    }
+}
+
+void container::ensure_layout() const {
+    if (layout_dirty) {
+        // Containers are only ever created non-const, by make_box and
+        // make_grid.
+        const_cast<container *>(this)->update_layout();
+        layout_dirty = false;
+    }
+}
 }  // namespace widgets
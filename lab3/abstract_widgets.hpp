@@ -2,6 +2,8 @@
 #define ABSTRACT_WIDGETS_HPP_
 
 namespace widgets {
+struct container;
+
 struct widget {
     virtual ~widget() = default;
 
@@ -19,12 +21,47 @@ struct widget {
 
     virtual widget *child_at(int x, int y);
 
+    // The container this widget has been added to, if any.
+    [[nodiscard]] container *parent() const {
+        return m_parent;
+    }
+
 protected:
     widget() = default;
+
+    // To be called whenever width() or height() may have changed, so that
+    // the ancestors lay themselves out again before they are next queried.
+    void size_changed();
+
+private:
+    friend struct container;
+
+    container *m_parent = nullptr;
 };
 
 struct container : widget {
+    // Recomputes the layout right away.
     virtual void update_layout() = 0;
+
+protected:
+    static void set_parent(widget &child, container *new_parent) {
+        child.m_parent = new_parent;
+    }
+
+    // Marks this container and its ancestors for layout. A dirty
+    // container's ancestors are always dirty too, so the walk stops at the
+    // first one that already is.
+    void mark_dirty();
+
+    // Lays the container out if anything below it has changed since the
+    // last time. Dirty children are laid out first, as update_layout asks
+    // them for their size.
+    void ensure_layout() const;
+
+private:
+    friend struct widget;
+
+    mutable bool layout_dirty = false;
 };
 }  // namespace widgets
 
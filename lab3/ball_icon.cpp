@@ -19,6 +19,7 @@ ball_icon::ball_icon(int ball_radius) : ball_radius(ball_radius) {
 
 void ball_icon::radius(int new_radius) {
     ball_radius = new_radius;
+    size_changed();
 }
 
 widget *ball_icon::child_at(int x, int y) {
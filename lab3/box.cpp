@@ -1,53 +1,48 @@
 
 
 #include "box.hpp"
+#include <algorithm>
+#include <cstddef>
 
 namespace widgets {
 
 void box::update_layout() {
-    if (box_kind == kind::HORIZONTAL) {
-        box_height = 0;
-        int current_width = 0;
-        for (const auto &child : children) {
-            box_height = std::max(child->height(), box_height);
-            current_width += child->width();
-        }
-        box_width = current_width;
-    } else {
-        box_width = 0;
-        int current_height = 0;
-        for (const auto &child : children) {
-            box_width = std::max(child->width(), box_width);
-            current_height += child->height();
-        }
-        box_height = current_height;
+    const bool horizontal = box_kind == kind::HORIZONTAL;
+    child_offsets.resize(children.size() + 1);
+    child_shifts.resize(children.size());
+    int across = 0;
+    for (std::size_t i = 0; i < children.size(); i++) {
+        const int child_width = children[i]->width();
+        const int child_height = children[i]->height();
+        child_offsets[i + 1] =
+            child_offsets[i] + (horizontal ? child_width : child_height);
+        // Stash the extent across the box until the box's one is known.
+        child_shifts[i] = horizontal ? child_height : child_width;
+        across = std::max(child_shifts[i], across);
     }
+    for (int &shift : child_shifts) {
+        shift = (across - shift) / 2;
+    }
+    box_width = horizontal ? child_offsets.back() : across;
+    box_height = horizontal ? across : child_offsets.back();
 }
 
 widget *box::child_at(int x, int y) {
-    if (box_kind == kind::HORIZONTAL) {
-        int current_width = 0;
-        for (const auto &child : children) {
-            if (current_width + child->width() > x) {
-                return child->child_at(
-                    x - current_width, y - (box_height - child->height()) / 2
-                );
-            }
-            current_width += child->width();
-        }
-        return nullptr;
-    } else {
-        int current_height = 0;
-        for (const auto &child : children) {
-            if (current_height + child->height() > y) {
-                return child->child_at(
-                    x - (box_width - child->width()) / 2, y - current_height
-                );
-            }
-            current_height += child->height();
-        }
+    ensure_layout();
+    const bool horizontal = box_kind == kind::HORIZONTAL;
+    // The first child that ends past the point, as in a walk from the start.
+    const auto end = std::upper_bound(
+        child_offsets.begin() + 1, child_offsets.end(), horizontal ? x : y
+    );
+    if (end == child_offsets.end()) {
         return nullptr;
     }
+    const auto index =
+        static_cast<std::size_t>(end - child_offsets.begin() - 1);
+    const int along = child_offsets[index];
+    const int shift = child_shifts[index];
+    return horizontal ? children[index]->child_at(x - along, y - shift)
+                      : children[index]->child_at(x - shift, y - along);
 }
 
 widget *box::get(int index) const {
@@ -55,8 +50,9 @@ widget *box::get(int index) const {
 }
 
 widget *box::add(std::unique_ptr<widget> new_widget) {
+    set_parent(*new_widget, this);
     children.push_back(std::move(new_widget));
-    update_layout();
+    mark_dirty();
     return children[size() - 1].get();
 }
 
@@ -64,15 +60,18 @@ std::unique_ptr<widget> box::remove(int index) {
     auto it = children.begin() + index;
     std::unique_ptr<widget> removed_element = std::move(children[index]);
     children.erase(it);
-    update_layout();
+    set_parent(*removed_element, nullptr);
+    mark_dirty();
     return removed_element;
 }
 
 [[nodiscard]] int box::width() const {
+    ensure_layout();
     return box_width;
 }
 
 [[nodiscard]] int box::height() const {
+    ensure_layout();
     return box_height;
 }
 
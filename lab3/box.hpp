@@ -35,6 +35,11 @@ private:
     std::vector<std::unique_ptr<widget>> children;
     kind box_kind;
     int box_width = 0, box_height = 0;
+    // Filled by update_layout: child i spans [child_offsets[i],
+    // child_offsets[i + 1]) along the box and is shifted by child_shifts[i]
+    // across it to be centered.
+    std::vector<int> child_offsets{0};
+    std::vector<int> child_shifts;
 };
 
 [[nodiscard]] std::unique_ptr<box> make_box(const box::kind &kind);
@@ -18,6 +18,7 @@ struct button final : widget {
 
     void label(std::string new_label) {
         m_label = std::move(new_label);
+        size_changed();
     }
 
 private:
@@ -28,6 +28,7 @@ void grid::update_layout() {
 }
 
 widget *grid::child_at(int x, int y) {
+    ensure_layout();
     int current_width = 0;
     int current_height = 0;
     int row = 0;
@@ -60,23 +61,31 @@ widget *grid::get(int row, int column) const {
 }
 
 widget *grid::add(std::unique_ptr<widget> new_widget, int row, int column) {
+    if (new_widget != nullptr) {
+        set_parent(*new_widget, this);
+    }
     children[row][column] = std::move(new_widget);
-    update_layout();
+    mark_dirty();
     return children[row][column].get();
 }
 
 std::unique_ptr<widget> grid::remove(int row, int column) {
     std::unique_ptr<widget> removed_element = std::move(children[row][column]);
     children[row][column] = nullptr;
-    update_layout();
+    if (removed_element != nullptr) {
+        set_parent(*removed_element, nullptr);
+    }
+    mark_dirty();
     return removed_element;
 }
 
 [[nodiscard]] int grid::width() const {
+    ensure_layout();
     return grid_width;
 }
 
 [[nodiscard]] int grid::height() const {
+    ensure_layout();
     return grid_height;
 }
 
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+#include "shared_ptr.hpp"
+
+namespace ptrs::shared {
+// shared_ptr<T, atomic_count> that many threads may load and replace at the
+// same time without locks, e.g. to publish immutable snapshots.
+//
+// The control block address and a 16-bit local count share one atomic
+// word. Every time a block is put into the word, BATCH references are added
+// to its counter in advance, and a load only bumps the local count to claim
+// one of them, so readers never touch the word twice and never wait.
+// Whoever takes the block out of the word gives back the references nobody
+// claimed. Once half of a batch is gone, loads put the block back with a
+// fresh batch; until one of them succeeds every thread claims at most one
+// more reference, so fewer than BATCH / 2 threads can never run out. The
+// references held in reserve show up in use_count() of the object.
+//
+// Packing assumes that control blocks live below 2^48. That holds for user
+// space on x86-64 and AArch64 with 4-level page tables, but not once 5-level
+// paging (LA57) hands out higher addresses, nor with pointer tagging schemes
+// (top-byte ignore, MTE) that use the high bits. Debug builds assert that
+// every block fits.
+template <typename T>
+class atomic_shared_ptr {
+    using pointer = shared_ptr<T, atomic_count>;
+    using block_type = typename pointer::block_type;
+    using word = std::uintptr_t;
+
+    static_assert(sizeof(word) == 8, "Needs 64-bit pointers");
+
+    static constexpr int LOCAL_SHIFT = 48;
+    static constexpr word ONE_LOCAL = word(1) << LOCAL_SHIFT;
+    static constexpr word BLOCK_MASK = ONE_LOCAL - 1;
+    static constexpr long BATCH = 1L << 15;
+    static constexpr long REFILL_AT = BATCH / 2;
+
+    mutable std::atomic<word> state{0};
+
+    static block_type *block_of(word value) {
+        return reinterpret_cast<block_type *>(value & BLOCK_MASK);
+    }
+
+    static long local_of(word value) {
+        return static_cast<long>(value >> LOCAL_SHIFT);
+    }
+
+    static void add_references(block_type *block, long count) {
+        if (block != nullptr) {
+            block->counter.fetch_add(count, std::memory_order_relaxed);
+        }
+    }
+
+    static pointer adopt(block_type *block) {
+        if (block == nullptr) {
+            return pointer();
+        }
+        return pointer(static_cast<T *>(block->managed()), block);
+    }
+
+    // Word that owns the reference of desired and a batch on top of it.
+    static word install(pointer &desired) {
+        block_type *block = std::exchange(desired.block, nullptr);
+        desired.ptr = nullptr;
+        assert((reinterpret_cast<word>(block) & ~BLOCK_MASK) == 0);
+        add_references(block, BATCH);
+        return reinterpret_cast<word>(block);
+    }
+
+    // The reference held by a word that has just been replaced. Its
+    // unclaimed batch is returned first; the word's own reference is still
+    // there, so the counter cannot reach zero.
+    static pointer retire(word replaced) {
+        block_type *block = block_of(replaced);
+        add_references(block, local_of(replaced) - BATCH);
+        return adopt(block);
+    }
+
+    // Puts block back with a fresh batch unless someone else already has.
+    // The caller holds a reference, which keeps block alive.
+    void refill(block_type *block, word current) const {
+        add_references(block, BATCH);
+        while (block_of(current) == block && local_of(current) >= REFILL_AT) {
+            if (state.compare_exchange_weak(
+                    current, reinterpret_cast<word>(block),
+                    std::memory_order_relaxed
+                )) {
+                add_references(block, local_of(current) - BATCH);
+                return;
+            }
+        }
+        add_references(block, -BATCH);
+    }
+
+public:
+    atomic_shared_ptr() = default;
+
+    explicit atomic_shared_ptr(pointer desired) : state(install(desired)) {
+    }
+
+    atomic_shared_ptr(const atomic_shared_ptr &) = delete;
+
+    atomic_shared_ptr(atomic_shared_ptr &&) = delete;
+
+    atomic_shared_ptr &operator=(const atomic_shared_ptr &) = delete;
+
+    atomic_shared_ptr &operator=(atomic_shared_ptr &&) = delete;
+
+    ~atomic_shared_ptr() {
+        retire(state.load(std::memory_order_acquire));
+    }
+
+    atomic_shared_ptr &operator=(pointer desired) {
+        store(std::move(desired));
+        return *this;
+    }
+
+    // cppcheck-suppress noExplicitConstructor
+    operator pointer() const {
+        return load();
+    }
+
+    [[nodiscard]] pointer load() const {
+        const word taken =
+            state.fetch_add(ONE_LOCAL, std::memory_order_acquire);
+        block_type *block = block_of(taken);
+        // An empty word has no batch; its local count is never looked at.
+        if (block != nullptr && local_of(taken) + 1 >= REFILL_AT) {
+            refill(block, taken + ONE_LOCAL);
+        }
+        return adopt(block);
+    }
+
+    void store(pointer desired) {
+        exchange(std::move(desired));
+    }
+
+    pointer exchange(pointer desired) {
+        return retire(
+            state.exchange(install(desired), std::memory_order_acq_rel)
+        );
+    }
+
+    // Replaces the value with desired if it owns the same object as
+    // expected; otherwise loads the current value into expected.
+    bool compare_exchange_strong(pointer &expected, pointer desired) {
+        word current = state.load(std::memory_order_relaxed);
+        if (block_of(current) == expected.block) {
+            const word replacement = install(desired);
+            do {
+                if (state.compare_exchange_weak(
+                        current, replacement, std::memory_order_acq_rel,
+                        std::memory_order_relaxed
+                    )) {
+                    retire(current);
+                    return true;
+                }
+            } while (block_of(current) == expected.block);
+            // Nothing was replaced: take back what install did.
+            retire(replacement);
+        }
+        expected = load();
+        return false;
+    }
+
+    bool compare_exchange_weak(pointer &expected, pointer desired) {
+        return compare_exchange_strong(expected, std::move(desired));
+    }
+
+    [[nodiscard]] bool is_lock_free() const {
+        return state.is_lock_free();
+    }
+};
+}  // namespace ptrs::shared
@@ -0,0 +1,192 @@
+// Read-mostly publish/subscribe throughput of atomic_shared_ptr against a
+// shared_ptr guarded by a mutex.
+//
+//     atomic_shared_ptr_benchmark [milliseconds] [max_threads]
+//
+// Reader threads keep loading the current configuration snapshot and reading
+// it while one writer publishes a new snapshot every 100 microseconds.
+// Reported is the total number of loads per second and the mean time of a
+// load as seen by one reader. Every snapshot carries a checksum of its
+// contents; a reader that sees a torn or destroyed snapshot, or a snapshot
+// that outlives the run, makes the program exit with status 1.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "atomic_shared_ptr.hpp"
+
+namespace {
+using ptrs::shared::atomic_count;
+using ptrs::shared::atomic_shared_ptr;
+using ptrs::shared::make_shared;
+using ptrs::shared::shared_ptr;
+
+std::atomic<long> live_snapshots{0};
+
+struct snapshot {
+    static constexpr std::size_t VALUES = 8;
+
+    long version;
+    long values[VALUES];
+    long checksum = 0;
+
+    explicit snapshot(long version) : version(version) {
+        for (std::size_t i = 0; i < VALUES; i++) {
+            values[i] = version * static_cast<long>(i + 1);
+            checksum += values[i];
+        }
+        live_snapshots.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    snapshot(const snapshot &) = delete;
+
+    snapshot &operator=(const snapshot &) = delete;
+
+    ~snapshot() {
+        checksum = -1;
+        live_snapshots.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] bool consistent() const {
+        long sum = 0;
+        for (long value : values) {
+            sum += value;
+        }
+        return sum == checksum && values[0] == version;
+    }
+};
+
+using snapshot_ptr = shared_ptr<snapshot, atomic_count>;
+
+class locked_config {
+    mutable std::mutex mutex;
+    snapshot_ptr current;
+
+public:
+    explicit locked_config(snapshot_ptr initial) : current(std::move(initial)) {
+    }
+
+    snapshot_ptr load() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return current;
+    }
+
+    void store(snapshot_ptr desired) {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::swap(current, desired);
+    }
+};
+
+class lock_free_config {
+    atomic_shared_ptr<snapshot> current;
+
+public:
+    explicit lock_free_config(snapshot_ptr initial)
+        : current(std::move(initial)) {
+    }
+
+    snapshot_ptr load() const {
+        return current.load();
+    }
+
+    void store(snapshot_ptr desired) {
+        current.store(std::move(desired));
+    }
+};
+
+struct result {
+    double loads_per_second;
+    double ns_per_load;
+};
+
+template <typename Config>
+result run(std::size_t threads, std::chrono::milliseconds duration) {
+    Config config(make_shared<snapshot, atomic_count>(0));
+    std::atomic<bool> stop{false};
+    std::atomic<std::size_t> loads{0};
+    std::atomic<bool> torn{false};
+
+    std::vector<std::thread> readers;
+    for (std::size_t i = 0; i < threads; i++) {
+        readers.emplace_back([&] {
+            std::size_t done = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                const snapshot_ptr current = config.load();
+                if (!current->consistent()) {
+                    torn.store(true);
+                }
+                done++;
+            }
+            loads.fetch_add(done);
+        });
+    }
+    std::thread writer([&] {
+        for (long version = 1; !stop.load(std::memory_order_relaxed);
+             version++) {
+            config.store(make_shared<snapshot, atomic_count>(version));
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+        }
+    });
+
+    const auto start = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(duration);
+    stop.store(true);
+    for (auto &reader : readers) {
+        reader.join();
+    }
+    writer.join();
+    const double seconds = std::chrono::duration<double>(
+                               std::chrono::steady_clock::now() - start
+    )
+                               .count();
+
+    if (torn.load()) {
+        std::cout << "a reader saw a torn or destroyed snapshot\n";
+        std::exit(1);
+    }
+    const double total = static_cast<double>(loads.load());
+    return {
+        total / seconds,
+        seconds * 1e9 * static_cast<double>(threads) / std::max(total, 1.0)};
+}
+
+void report(const std::string &config, std::size_t threads, result value) {
+    std::cout << std::left << std::setw(12) << config << std::right
+              << std::setw(8) << threads << std::setw(14) << std::fixed
+              << std::setprecision(1) << value.loads_per_second / 1e6
+              << std::setw(12) << std::setprecision(1) << value.ns_per_load
+              << "\n";
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+    const std::chrono::milliseconds duration(
+        argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 500
+    );
+    const std::size_t max_threads =
+        argc > 2 ? std::strtoull(argv[2], nullptr, 10)
+                 : std::max(std::thread::hardware_concurrency(), 1U);
+
+    std::cout << std::left << std::setw(12) << "config" << std::right
+              << std::setw(8) << "readers" << std::setw(14) << "Mloads/s"
+              << std::setw(12) << "ns/load\n";
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+        report("mutex", threads, run<locked_config>(threads, duration));
+        report("lock-free", threads, run<lock_free_config>(threads, duration));
+        if (threads < max_threads && threads * 2 > max_threads) {
+            threads = max_threads / 2;
+        }
+    }
+    if (live_snapshots.load() != 0) {
+        std::cout << live_snapshots.load() << " snapshot(s) leaked\n";
+        return 1;
+    }
+    return 0;
+}
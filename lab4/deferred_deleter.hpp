@@ -0,0 +1,134 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ptrs::deferred {
+// Background thread that destroys objects handed to it, so that releasing
+// the last reference to a large object graph on a latency-critical thread
+// only costs an enqueue. Objects are destroyed in batches, in the order they
+// were retired.
+class reclaimer {
+    struct garbage {
+        void *object;
+        void (*destroy)(void *);
+    };
+
+    std::mutex mutex;
+    std::condition_variable wake_up;
+    std::condition_variable reclaimed;
+    std::vector<garbage> queue;
+    std::size_t retired = 0;
+    std::size_t destroyed = 0;
+    bool stopping = false;
+    // Started last, once everything it uses is initialized.
+    std::thread worker;
+
+    void worker_loop() {
+        std::vector<garbage> batch;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake_up.wait(lock, [this] {
+                return stopping || !queue.empty();
+            });
+            if (queue.empty()) {
+                return;
+            }
+            batch.swap(queue);
+            lock.unlock();
+            for (const garbage &item : batch) {
+                item.destroy(item.object);
+            }
+            const std::size_t count = batch.size();
+            batch.clear();
+            lock.lock();
+            destroyed += count;
+            reclaimed.notify_all();
+        }
+    }
+
+public:
+    reclaimer() : worker([this] { worker_loop(); }) {
+    }
+
+    reclaimer(const reclaimer &) = delete;
+
+    reclaimer(reclaimer &&) = delete;
+
+    reclaimer &operator=(const reclaimer &) = delete;
+
+    reclaimer &operator=(reclaimer &&) = delete;
+
+    // Destroys whatever is still queued before returning.
+    ~reclaimer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake_up.notify_one();
+        worker.join();
+    }
+
+    // Shared reclaimer; nothing may be retired to it during static
+    // destruction, after it has stopped.
+    static reclaimer &instance() {
+        static reclaimer shared;
+        return shared;
+    }
+
+    // Queues object for destroy(object). If the queue cannot grow, the
+    // object is destroyed right away instead.
+    void retire(void *object, void (*destroy)(void *)) {
+        bool was_empty = false;
+        try {
+            std::lock_guard<std::mutex> lock(mutex);
+            was_empty = queue.empty();
+            queue.push_back({object, destroy});
+            retired++;
+        } catch (...) {
+            destroy(object);
+            return;
+        }
+        // Otherwise the worker has been woken up already.
+        if (was_empty) {
+            wake_up.notify_one();
+        }
+    }
+
+    // Waits until everything retired before the call has been destroyed.
+    // Must not be called from a destructor run by the reclaimer itself.
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        const std::size_t target = retired;
+        reclaimed.wait(lock, [&] { return destroyed >= target; });
+    }
+};
+
+// Deleter for unique_ptr and shared_ptr that leaves the delete to the shared
+// reclaimer.
+template <typename T>
+struct deferred_deleter {
+    void operator()(T *ptr) const {
+        reclaimer::instance().retire(ptr, [](void *object) {
+            delete static_cast<T *>(object);
+        });
+    }
+};
+
+template <typename T>
+struct deferred_deleter<T[]> {
+    void operator()(T *ptr) const {
+        reclaimer::instance().retire(ptr, [](void *object) {
+            delete[] static_cast<T *>(object);
+        });
+    }
+};
+
+// Waits until the shared reclaimer has destroyed everything retired so far.
+inline void flush() {
+    reclaimer::instance().flush();
+}
+}  // namespace ptrs::deferred
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+#include "shared_ptr.hpp"
+
+namespace ptrs::intrusive {
+// Owning pointer whose reference count lives inside the object, so the
+// pointer is one word and sharing an object needs no allocation beyond the
+// object itself. T is hooked up through functions found by ADL:
+//
+//     void intrusive_ptr_add_ref(T *object);
+//     void intrusive_ptr_release(T *object);  // deletes at zero
+//     long intrusive_ptr_use_count(const T *object);  // for use_count()
+//
+// Deriving from intrusive_ref_counter<T> provides all three.
+template <typename T>
+class intrusive_ptr {
+    T *ptr = nullptr;
+
+    void increase_counter() {
+        if (ptr != nullptr) {
+            intrusive_ptr_add_ref(ptr);
+        }
+    }
+
+    void reset_(T *new_ptr) {
+        if (ptr != nullptr) {
+            intrusive_ptr_release(ptr);
+        }
+        ptr = new_ptr;
+    }
+
+public:
+    intrusive_ptr() = default;
+
+    // cppcheck-suppress noExplicitConstructor
+    intrusive_ptr(std::nullptr_t) {
+    }
+
+    // Adds a reference to ptr, which may already be owned by other
+    // intrusive_ptr.
+    explicit intrusive_ptr(T *ptr) : ptr(ptr) {
+        increase_counter();
+    }
+
+    intrusive_ptr(const intrusive_ptr &other) : ptr(other.ptr) {
+        increase_counter();
+    }
+
+    intrusive_ptr(intrusive_ptr &&other)
+        : ptr(std::exchange(other.ptr, nullptr)) {
+    }
+
+    intrusive_ptr &operator=(const intrusive_ptr &other) {
+        if (this != &other) {
+            T *new_ptr = other.ptr;
+            if (new_ptr != nullptr) {
+                intrusive_ptr_add_ref(new_ptr);
+            }
+            reset_(new_ptr);
+        }
+        return *this;
+    }
+
+    intrusive_ptr &operator=(intrusive_ptr &&other) {
+        if (this != &other) {
+            reset_(std::exchange(other.ptr, nullptr));
+        }
+        return *this;
+    }
+
+    ~intrusive_ptr() {
+        reset_(nullptr);
+    }
+
+    [[nodiscard]] T *get() const {
+        return ptr;
+    }
+
+    T &operator*() const {
+        return *ptr;
+    }
+
+    T *operator->() const {
+        return ptr;
+    }
+
+    void reset(T *new_ptr = nullptr) {
+        if (new_ptr != nullptr) {
+            intrusive_ptr_add_ref(new_ptr);
+        }
+        reset_(new_ptr);
+    }
+
+    [[nodiscard]] long use_count() const {
+        return ptr == nullptr ? 0 : intrusive_ptr_use_count(ptr);
+    }
+
+    explicit operator bool() const {
+        return ptr != nullptr;
+    }
+
+    friend void swap(intrusive_ptr &lhs, intrusive_ptr &rhs) {
+        std::swap(lhs.ptr, rhs.ptr);
+    }
+
+    friend bool operator==(const intrusive_ptr &lhs, const intrusive_ptr &rhs) {
+        return lhs.ptr == rhs.ptr;
+    }
+
+    friend bool operator!=(const intrusive_ptr &lhs, const intrusive_ptr &rhs) {
+        return !(lhs == rhs);
+    }
+};
+
+// Base class that embeds the counter in Derived, using the shared_ptr
+// counting policies. Copies of an object start with a fresh count.
+template <typename Derived, typename RefCount = shared::non_atomic_count>
+class intrusive_ref_counter {
+    mutable typename RefCount::counter_type counter{0};
+
+    friend void intrusive_ptr_add_ref(const Derived *object) {
+        RefCount::increment(object->intrusive_ref_counter::counter);
+    }
+
+    friend void intrusive_ptr_release(const Derived *object) {
+        if (RefCount::decrement(object->intrusive_ref_counter::counter)) {
+            delete object;
+        }
+    }
+
+    friend long intrusive_ptr_use_count(const Derived *object) {
+        return RefCount::load(object->intrusive_ref_counter::counter);
+    }
+
+protected:
+    intrusive_ref_counter() = default;
+
+    intrusive_ref_counter(const intrusive_ref_counter &) {
+    }
+
+    intrusive_ref_counter &operator=(const intrusive_ref_counter &) {
+        return *this;
+    }
+
+    ~intrusive_ref_counter() = default;
+};
+
+template <typename T, typename... Args>
+intrusive_ptr<T> make_intrusive(Args &&...args) {
+    return intrusive_ptr<T>(new T(std::forward<Args>(args)...));
+}
+}  // namespace ptrs::intrusive
@@ -0,0 +1,237 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include "shared_ptr.hpp"
+#include "unique_ptr.hpp"
+
+namespace ptrs::pool {
+// Per-thread free list of blocks of Size bytes aligned to Align, so
+// allocating is a pop and freeing a push. Blocks come from chunks that
+// grow geometrically and are never returned to the system: a block may be
+// freed by a thread other than the one that allocated it (it then joins
+// the freeing thread's list), and the chunk must outlive every such block.
+// A thread that frees more than it allocates, like the consumer of a
+// producer/consumer pair, keeps at most LOCAL_LIMIT blocks and spills the
+// rest to a shared list, where threads that run dry look before carving a
+// new chunk. The lists of exiting threads go there too. Objects must not be
+// freed into the pool during static destruction, after their thread's pool
+// is gone.
+template <std::size_t Size, std::size_t Align>
+class fixed_size_pool {
+    union block {
+        block *next;
+        alignas(Align) unsigned char storage[Size];
+    };
+
+    static constexpr std::size_t FIRST_CHUNK_BLOCKS = 32;
+    static constexpr std::size_t MAX_CHUNK_BLOCKS = 4096;
+    // Past this many free blocks a thread keeps the LOCAL_LIMIT / 2 most
+    // recently freed ones and spills the others.
+    static constexpr std::size_t LOCAL_LIMIT = 2 * MAX_CHUNK_BLOCKS;
+
+    // Free blocks that belong to no thread.
+    struct spare_list {
+        std::mutex mutex;
+        block *first = nullptr;
+        block *last = nullptr;
+        std::size_t count = 0;
+    };
+
+    static inline std::atomic<std::size_t> reserved{0};
+
+    block *free = nullptr;
+    // Only meaningful while free is not null.
+    block *last = nullptr;
+    std::size_t count = 0;
+    std::size_t chunk_blocks = FIRST_CHUNK_BLOCKS;
+
+    static spare_list &spares() {
+        static spare_list instance;
+        return instance;
+    }
+
+    // Hands the chain first..last of `blocks` blocks to the spare list.
+    static void spare(block *first, block *last, std::size_t blocks) {
+        spare_list &list = spares();
+        std::lock_guard<std::mutex> lock(list.mutex);
+        last->next = list.first;
+        if (list.first == nullptr) {
+            list.last = last;
+        }
+        list.first = first;
+        list.count += blocks;
+    }
+
+    void refill() {
+        {
+            spare_list &list = spares();
+            std::lock_guard<std::mutex> lock(list.mutex);
+            free = std::exchange(list.first, nullptr);
+            last = std::exchange(list.last, nullptr);
+            count = std::exchange(list.count, 0);
+        }
+        if (free != nullptr) {
+            return;
+        }
+        auto *chunk = static_cast<block *>(::operator new(
+            chunk_blocks * sizeof(block), std::align_val_t(alignof(block))
+        ));
+        for (std::size_t i = 0; i < chunk_blocks; i++) {
+            chunk[i].next = i + 1 < chunk_blocks ? chunk + i + 1 : nullptr;
+        }
+        free = chunk;
+        last = chunk + chunk_blocks - 1;
+        count = chunk_blocks;
+        reserved.fetch_add(chunk_blocks, std::memory_order_relaxed);
+        chunk_blocks = std::min(chunk_blocks * 2, MAX_CHUNK_BLOCKS);
+    }
+
+    void spill() {
+        block *kept = free;
+        for (std::size_t i = 1; i < LOCAL_LIMIT / 2; i++) {
+            kept = kept->next;
+        }
+        spare(kept->next, last, count - LOCAL_LIMIT / 2);
+        kept->next = nullptr;
+        last = kept;
+        count = LOCAL_LIMIT / 2;
+    }
+
+    fixed_size_pool() = default;
+
+public:
+    fixed_size_pool(const fixed_size_pool &) = delete;
+
+    fixed_size_pool(fixed_size_pool &&) = delete;
+
+    fixed_size_pool &operator=(const fixed_size_pool &) = delete;
+
+    fixed_size_pool &operator=(fixed_size_pool &&) = delete;
+
+    ~fixed_size_pool() {
+        if (free != nullptr) {
+            spare(free, last, count);
+        }
+    }
+
+    // The calling thread's pool.
+    static fixed_size_pool &local() {
+        thread_local fixed_size_pool pool;
+        return pool;
+    }
+
+    // Number of blocks carved from chunks so far by all threads.
+    static std::size_t reserved_blocks() {
+        return reserved.load(std::memory_order_relaxed);
+    }
+
+    void *allocate() {
+        if (free == nullptr) {
+            refill();
+        }
+        block *result = free;
+        free = result->next;
+        count--;
+        return result;
+    }
+
+    void deallocate(void *pointer) noexcept {
+        auto *freed = static_cast<block *>(pointer);
+        if (free == nullptr) {
+            last = freed;
+        }
+        freed->next = free;
+        free = freed;
+        if (++count > LOCAL_LIMIT) {
+            spill();
+        }
+    }
+};
+
+// Objects of type T share the pool of every type with the same size and
+// alignment.
+template <typename T>
+using object_pool = fixed_size_pool<sizeof(T), alignof(T)>;
+
+// Destroys the object and gives its memory back to the pool of the current
+// thread.
+template <typename T>
+struct pool_deleter {
+    void operator()(T *ptr) const {
+        ptr->~T();
+        object_pool<T>::local().deallocate(ptr);
+    }
+};
+
+// Allocator that serves single objects from the thread-local pools and
+// anything larger from operator new, for allocate_shared and containers of
+// nodes.
+template <typename T>
+struct pool_allocator {
+    using value_type = T;
+
+    pool_allocator() = default;
+
+    template <typename U>
+    // cppcheck-suppress noExplicitConstructor
+    pool_allocator(const pool_allocator<U> &) noexcept {
+    }
+
+    T *allocate(std::size_t count) {
+        if (count == 1) {
+            return static_cast<T *>(object_pool<T>::local().allocate());
+        }
+        return std::allocator<T>().allocate(count);
+    }
+
+    void deallocate(T *ptr, std::size_t count) noexcept {
+        if (count == 1) {
+            object_pool<T>::local().deallocate(ptr);
+        } else {
+            std::allocator<T>().deallocate(ptr, count);
+        }
+    }
+
+    friend bool operator==(const pool_allocator &, const pool_allocator &) {
+        return true;
+    }
+
+    friend bool operator!=(const pool_allocator &, const pool_allocator &) {
+        return false;
+    }
+};
+
+template <typename T>
+using pooled_unique_ptr = unique::unique_ptr<T, pool_deleter<T>>;
+
+// Creates a T in pool memory; destroying the pointer returns the memory.
+template <typename T, typename... Args>
+pooled_unique_ptr<T> make_pooled_unique(Args &&...args) {
+    object_pool<T> &pool = object_pool<T>::local();
+    void *memory = pool.allocate();
+    try {
+        T *object = new (memory) T(std::forward<Args>(args)...);
+        return pooled_unique_ptr<T>(object);
+    } catch (...) {
+        pool.deallocate(memory);
+        throw;
+    }
+}
+
+// Creates a T together with its control block in one pool block.
+template <
+    typename T,
+    typename RefCount = shared::non_atomic_count,
+    typename... Args>
+shared::shared_ptr<T, RefCount> make_pooled_shared(Args &&...args) {
+    return shared::allocate_shared<T, RefCount>(
+        pool_allocator<T>(), std::forward<Args>(args)...
+    );
+}
+}  // namespace ptrs::pool
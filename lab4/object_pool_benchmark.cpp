@@ -0,0 +1,159 @@
+// Allocation throughput of pooled pointers against plain new and delete,
+// and a check that the pool does not grow when objects are allocated on one
+// thread and freed on another.
+//
+//     object_pool_benchmark [objects]
+//
+// In the "local" scenario one thread creates and destroys objects; in the
+// "handoff" one a producer creates them and passes them in batches to a
+// consumer that destroys them, so the consumer's pool only ever receives
+// blocks. Reported is the mean time per object. If the pool has carved
+// more than MAX_RESERVED_BLOCKS blocks by the end, memory freed by the
+// consumer does not find its way back to the producer and the program
+// exits with status 1.
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "object_pool.hpp"
+
+namespace {
+using ptrs::pool::make_pooled_unique;
+using ptrs::pool::object_pool;
+using ptrs::unique::unique_ptr;
+
+struct payload {
+    long values[6] = {};
+
+    explicit payload(long value) {
+        values[0] = value;
+    }
+};
+
+constexpr std::size_t BATCH = 256;
+constexpr std::size_t MAX_QUEUED_BATCHES = 16;
+constexpr std::size_t MAX_RESERVED_BLOCKS = 64 * 1024;
+
+// Bounded queue of batches of pointers.
+template <typename Pointer>
+class handoff_queue {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::vector<Pointer>> batches;
+    bool closed = false;
+
+public:
+    void push(std::vector<Pointer> batch) {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this] {
+            return batches.size() < MAX_QUEUED_BATCHES;
+        });
+        batches.push_back(std::move(batch));
+        changed.notify_all();
+    }
+
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+        changed.notify_all();
+    }
+
+    // False once the queue is closed and empty.
+    bool pop(std::vector<Pointer> &batch) {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this] { return closed || !batches.empty(); });
+        if (batches.empty()) {
+            return false;
+        }
+        batch = std::move(batches.front());
+        batches.pop_front();
+        changed.notify_all();
+        return true;
+    }
+};
+
+template <typename Make>
+double local(std::size_t objects, Make make) {
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < objects; i++) {
+        auto object = make(static_cast<long>(i));
+        // Keeps the object from being optimized away.
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+    return std::chrono::duration<double, std::nano>(
+               std::chrono::steady_clock::now() - start
+           )
+               .count() /
+           static_cast<double>(objects);
+}
+
+template <typename Make>
+double handoff(std::size_t objects, Make make) {
+    using pointer = decltype(make(0L));
+    handoff_queue<pointer> queue;
+    const auto start = std::chrono::steady_clock::now();
+    std::thread consumer([&] {
+        std::vector<pointer> batch;
+        while (queue.pop(batch)) {
+            batch.clear();
+        }
+    });
+    std::vector<pointer> batch;
+    for (std::size_t i = 0; i < objects; i++) {
+        batch.push_back(make(static_cast<long>(i)));
+        if (batch.size() == BATCH) {
+            queue.push(std::exchange(batch, {}));
+        }
+    }
+    queue.push(std::move(batch));
+    queue.close();
+    consumer.join();
+    return std::chrono::duration<double, std::nano>(
+               std::chrono::steady_clock::now() - start
+           )
+               .count() /
+           static_cast<double>(objects);
+}
+
+void report(const std::string &scenario, const std::string &how, double ns) {
+    std::cout << std::left << std::setw(10) << scenario << std::setw(10)
+              << how << std::right << std::setw(12) << std::fixed
+              << std::setprecision(1) << ns << "\n";
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t objects =
+        argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 2000000;
+
+    auto pooled = [](long value) {
+        return make_pooled_unique<payload>(value);
+    };
+    auto plain = [](long value) {
+        return unique_ptr<payload>(new payload(value));
+    };
+
+    std::cout << std::left << std::setw(10) << "scenario" << std::setw(10)
+              << "memory" << std::right << std::setw(12) << "ns/object\n";
+    report("local", "pool", local(objects, pooled));
+    report("local", "new", local(objects, plain));
+    report("handoff", "pool", handoff(objects, pooled));
+    report("handoff", "new", handoff(objects, plain));
+
+    const std::size_t reserved = object_pool<payload>::reserved_blocks();
+    if (reserved > MAX_RESERVED_BLOCKS) {
+        std::cout << "the pool has grown to " << reserved
+                  << " blocks: freed blocks are not reused\n";
+        return 1;
+    }
+    return 0;
+}
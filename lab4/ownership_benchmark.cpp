@@ -0,0 +1,130 @@
+// Compares the three shared ownership models of lab4: shared_ptr owning a
+// separately allocated object, shared_ptr from make_shared (object inside
+// the control block) and intrusive_ptr (count inside the object).
+//
+//     ownership_benchmark [objects] [repetitions]
+//
+// Reported per model: the pointer size, and the mean time per object to
+// create and destroy, to copy and destroy, and to read the objects through
+// a vector of pointers.
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "intrusive_ptr.hpp"
+#include "shared_ptr.hpp"
+
+namespace {
+struct payload {
+    long value;
+
+    explicit payload(long value) : value(value) {
+    }
+};
+
+struct intrusive_payload
+    : ptrs::intrusive::intrusive_ref_counter<intrusive_payload> {
+    long value;
+
+    explicit intrusive_payload(long value) : value(value) {
+    }
+};
+
+struct separate {
+    using pointer = ptrs::shared::shared_ptr<payload>;
+
+    static pointer make(long value) {
+        return pointer(new payload(value));
+    }
+};
+
+struct combined {
+    using pointer = ptrs::shared::shared_ptr<payload>;
+
+    static pointer make(long value) {
+        return ptrs::shared::make_shared<payload>(value);
+    }
+};
+
+struct intrusive {
+    using pointer = ptrs::intrusive::intrusive_ptr<intrusive_payload>;
+
+    static pointer make(long value) {
+        return ptrs::intrusive::make_intrusive<intrusive_payload>(value);
+    }
+};
+
+volatile long sink = 0;
+
+template <typename Operation>
+double ns_per_object(
+    std::size_t objects,
+    std::size_t repetitions,
+    Operation operation
+) {
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < repetitions; i++) {
+        operation();
+    }
+    return std::chrono::duration<double, std::nano>(
+               std::chrono::steady_clock::now() - start
+           )
+               .count() /
+           static_cast<double>(objects * repetitions);
+}
+
+template <typename Model>
+void benchmark(
+    const std::string &name,
+    std::size_t objects,
+    std::size_t repetitions
+) {
+    using pointer = typename Model::pointer;
+
+    const double create = ns_per_object(objects, repetitions, [&] {
+        std::vector<pointer> pointers;
+        pointers.reserve(objects);
+        for (std::size_t i = 0; i < objects; i++) {
+            pointers.push_back(Model::make(static_cast<long>(i)));
+        }
+    });
+
+    std::vector<pointer> pointers;
+    for (std::size_t i = 0; i < objects; i++) {
+        pointers.push_back(Model::make(static_cast<long>(i)));
+    }
+    const double copy = ns_per_object(objects, repetitions, [&] {
+        std::vector<pointer> copies(pointers);
+    });
+    const double read = ns_per_object(objects, repetitions, [&] {
+        long sum = 0;
+        for (const pointer &object : pointers) {
+            sum += object->value;
+        }
+        sink = sink + sum;
+    });
+
+    std::cout << std::left << std::setw(14) << name << std::right
+              << std::setw(8) << sizeof(pointer) << std::setw(14)
+              << std::fixed << std::setprecision(2) << create
+              << std::setw(14) << copy << std::setw(14) << read << "\n";
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t objects =
+        argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const std::size_t repetitions =
+        argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10;
+
+    std::cout << std::left << std::setw(14) << "model" << std::right
+              << std::setw(8) << "bytes" << std::setw(14) << "create ns"
+              << std::setw(14) << "copy ns" << std::setw(14) << "read ns\n";
+    benchmark<separate>("shared_ptr", objects, repetitions);
+    benchmark<combined>("make_shared", objects, repetitions);
+    benchmark<intrusive>("intrusive_ptr", objects, repetitions);
+    return 0;
+}
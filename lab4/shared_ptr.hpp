@@ -1,107 +1,327 @@
-#pragma once
-
-#include <algorithm>
-#include <iostream>
-#include <utility>
-
-namespace ptrs::shared {
-template <typename T>
-class shared_ptr {
-    T *ptr = nullptr;
-    int *counter = nullptr;
-
-    void increase_counter() {
-        if (counter != nullptr) {
-            ++*counter;
-        }
-    }
-
-    void reset_(T *new_ptr, int *new_counter) {
-        if (counter != nullptr && --*counter == 0) {
-            delete ptr;
-            delete counter;
-        }
-        ptr = new_ptr;
-        counter = new_counter;
-    }
-
-public:
-    shared_ptr() = default;
-
-    // cppcheck-suppress noExplicitConstructor
-    shared_ptr(std::nullptr_t) {
-    }
-
-    explicit shared_ptr(T *ptr) : ptr(ptr) {
-        if (ptr != nullptr) {
-            counter = new int(1);
-        }
-    }
-
-    shared_ptr(const shared_ptr &other)
-        // cppcheck-suppress copyCtorPointerCopying
-        : ptr(other.ptr), counter(other.counter) {
-        increase_counter();
-    }
-
-    shared_ptr(shared_ptr &&other)
-        : ptr(std::exchange(other.ptr, nullptr)),
-          counter(std::exchange(other.counter, nullptr)) {
-    }
-
-    shared_ptr &operator=(const shared_ptr &other) {
-        if (this != &other) {
-            reset_(other.ptr, other.counter);
-            increase_counter();
-        }
-        return *this;
-    }
-
-    shared_ptr &operator=(shared_ptr &&other) {
-        if (this != &other) {
-            reset_(
-                std::exchange(other.ptr, nullptr),
-                std::exchange(other.counter, nullptr)
-            );
-        }
-        return *this;
-    }
-
-    ~shared_ptr() {
-        reset_(nullptr, nullptr);
-    }
-
-    [[nodiscard]] T *get() const {
-        return ptr;
-    }
-
-    T &operator*() const {
-        return *ptr;
-    }
-
-    T *operator->() const {
-        return ptr;
-    }
-
-    void reset(T *new_ptr = nullptr) {
-        reset_(new_ptr, new_ptr == nullptr ? nullptr : new int(1));
-    }
-
-    explicit operator bool() const {
-        return ptr != nullptr;
-    }
-
-    friend void swap(shared_ptr &lhs, shared_ptr &rhs) {
-        std::swap(lhs.ptr, rhs.ptr);
-        std::swap(lhs.counter, rhs.counter);
-    }
-
-    friend bool operator==(const shared_ptr &lhs, const shared_ptr &rhs) {
-        return lhs.ptr == rhs.ptr;
-    }
-
-    friend bool operator!=(const shared_ptr &lhs, const shared_ptr &rhs) {
-        return !(lhs == rhs);
-    }
-};
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <utility>
+
+namespace ptrs::shared {
+// Reference counting policies. non_atomic_count is the cheap default for
+// pointers that never cross threads; atomic_count makes copies and resets
+// of pointers to the same object safe from any number of threads.
+struct non_atomic_count {
+    using counter_type = long;
+
+    static void increment(counter_type &counter) {
+        ++counter;
+    }
+
+    // True when the last reference is gone.
+    static bool decrement(counter_type &counter) {
+        return --counter == 0;
+    }
+
+    static long load(const counter_type &counter) {
+        return counter;
+    }
+};
+
+struct atomic_count {
+    using counter_type = std::atomic<long>;
+
+    // A new reference is made from an existing one, which keeps the object
+    // alive, so the increment needs no ordering.
+    static void increment(counter_type &counter) {
+        counter.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Release publishes our writes to the object; acquire in the thread
+    // that drops the last reference makes them visible to the destructor.
+    static bool decrement(counter_type &counter) {
+        return counter.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    }
+
+    static long load(const counter_type &counter) {
+        return counter.load(std::memory_order_relaxed);
+    }
+};
+
+namespace detail {
+// Reference count of one shared object together with the knowledge of how
+// to destroy it and free the memory involved.
+template <typename RefCount>
+struct control_block {
+    typename RefCount::counter_type counter{1};
+
+    control_block() = default;
+
+    control_block(const control_block &) = delete;
+
+    control_block(control_block &&) = delete;
+
+    control_block &operator=(const control_block &) = delete;
+
+    control_block &operator=(control_block &&) = delete;
+
+    // Destroys the object and frees both it and the block.
+    virtual void dispose() noexcept = 0;
+
+    // Address of the object, for code that only keeps the block.
+    virtual void *managed() noexcept = 0;
+
+protected:
+    ~control_block() = default;
+};
+
+// Block for an object allocated separately and destroyed with deleter.
+template <typename T, typename RefCount, typename Deleter>
+struct pointer_block final : control_block<RefCount> {
+    T *object;
+    Deleter deleter;
+
+    pointer_block(T *object, const Deleter &deleter)
+        : object(object), deleter(deleter) {
+    }
+
+    void dispose() noexcept override {
+        deleter(object);
+        delete this;
+    }
+
+    void *managed() noexcept override {
+        return object;
+    }
+};
+
+// Block that holds the object itself, so both come from one allocation and
+// the counter shares a cache line with the start of the object.
+template <typename T, typename RefCount, typename Alloc>
+struct inplace_block final : control_block<RefCount> {
+    using block_allocator = typename std::allocator_traits<
+        Alloc>::template rebind_alloc<inplace_block>;
+    using object_allocator =
+        typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+
+    object_allocator allocator;
+    alignas(T) unsigned char storage[sizeof(T)];
+
+    explicit inplace_block(const Alloc &alloc) : allocator(alloc) {
+    }
+
+    T *object() {
+        return reinterpret_cast<T *>(storage);
+    }
+
+    void dispose() noexcept override {
+        std::allocator_traits<object_allocator>::destroy(allocator, object());
+        block_allocator alloc(allocator);
+        std::allocator_traits<block_allocator>::destroy(alloc, this);
+        std::allocator_traits<block_allocator>::deallocate(alloc, this, 1);
+    }
+
+    void *managed() noexcept override {
+        return object();
+    }
+};
+}  // namespace detail
+
+template <typename T, typename RefCount>
+class shared_ptr;
+
+template <
+    typename T,
+    typename RefCount = non_atomic_count,
+    typename Alloc,
+    typename... Args>
+shared_ptr<T, RefCount> allocate_shared(const Alloc &alloc, Args &&...args);
+
+template <typename T>
+class atomic_shared_ptr;
+
+template <typename T, typename RefCount = non_atomic_count>
+class shared_ptr {
+    using block_type = detail::control_block<RefCount>;
+
+    T *ptr = nullptr;
+    block_type *block = nullptr;
+
+    template <typename U, typename R, typename Alloc, typename... Args>
+    friend shared_ptr<U, R> allocate_shared(const Alloc &alloc, Args &&...args);
+
+    friend class atomic_shared_ptr<T>;
+
+    // Adopts a block whose counter already accounts for this pointer.
+    shared_ptr(T *ptr, block_type *block) : ptr(ptr), block(block) {
+    }
+
+    template <typename Deleter = std::default_delete<T>>
+    static block_type *make_block(T *new_ptr, const Deleter &deleter = {}) {
+        if (new_ptr == nullptr) {
+            return nullptr;
+        }
+        try {
+            return new detail::pointer_block<T, RefCount, Deleter>(
+                new_ptr, deleter
+            );
+        } catch (...) {
+            deleter(new_ptr);
+            throw;
+        }
+    }
+
+    void increase_counter() {
+        if (block != nullptr) {
+            RefCount::increment(block->counter);
+        }
+    }
+
+    void reset_(T *new_ptr, block_type *new_block) {
+        if (block != nullptr && RefCount::decrement(block->counter)) {
+            block->dispose();
+        }
+        ptr = new_ptr;
+        block = new_block;
+    }
+
+public:
+    shared_ptr() = default;
+
+    // cppcheck-suppress noExplicitConstructor
+    shared_ptr(std::nullptr_t) {
+    }
+
+    // Takes ownership of ptr; if the control block cannot be allocated, ptr
+    // is deleted.
+    explicit shared_ptr(T *ptr) : ptr(ptr), block(make_block(ptr)) {
+    }
+
+    // Takes ownership of ptr, which is eventually passed to deleter; if the
+    // control block cannot be allocated, that happens right away.
+    template <typename Deleter>
+    shared_ptr(T *ptr, const Deleter &deleter)
+        : ptr(ptr), block(make_block(ptr, deleter)) {
+    }
+
+    shared_ptr(const shared_ptr &other)
+        // cppcheck-suppress copyCtorPointerCopying
+        : ptr(other.ptr), block(other.block) {
+        increase_counter();
+    }
+
+    shared_ptr(shared_ptr &&other)
+        : ptr(std::exchange(other.ptr, nullptr)),
+          block(std::exchange(other.block, nullptr)) {
+    }
+
+    shared_ptr &operator=(const shared_ptr &other) {
+        if (this != &other) {
+            reset_(other.ptr, other.block);
+            increase_counter();
+        }
+        return *this;
+    }
+
+    shared_ptr &operator=(shared_ptr &&other) {
+        if (this != &other) {
+            reset_(
+                std::exchange(other.ptr, nullptr),
+                std::exchange(other.block, nullptr)
+            );
+        }
+        return *this;
+    }
+
+    ~shared_ptr() {
+        reset_(nullptr, nullptr);
+    }
+
+    [[nodiscard]] T *get() const {
+        return ptr;
+    }
+
+    T &operator*() const {
+        return *ptr;
+    }
+
+    T *operator->() const {
+        return ptr;
+    }
+
+    void reset(T *new_ptr = nullptr) {
+        block_type *new_block = make_block(new_ptr);
+        reset_(new_ptr, new_block);
+    }
+
+    template <typename Deleter>
+    void reset(T *new_ptr, const Deleter &deleter) {
+        block_type *new_block = make_block(new_ptr, deleter);
+        reset_(new_ptr, new_block);
+    }
+
+    // Number of shared_ptr owning the object; only a hint while other
+    // threads copy or reset pointers to it.
+    [[nodiscard]] long use_count() const {
+        return block == nullptr ? 0 : RefCount::load(block->counter);
+    }
+
+    explicit operator bool() const {
+        return ptr != nullptr;
+    }
+
+    friend void swap(shared_ptr &lhs, shared_ptr &rhs) {
+        std::swap(lhs.ptr, rhs.ptr);
+        std::swap(lhs.block, rhs.block);
+    }
+
+    friend bool operator==(const shared_ptr &lhs, const shared_ptr &rhs) {
+        return lhs.ptr == rhs.ptr;
+    }
+
+    friend bool operator!=(const shared_ptr &lhs, const shared_ptr &rhs) {
+        return !(lhs == rhs);
+    }
+};
+
+// Creates the object and its control block with one allocation from alloc.
+template <typename T, typename RefCount, typename Alloc, typename... Args>
+shared_ptr<T, RefCount> allocate_shared(const Alloc &alloc, Args &&...args) {
+    using block = detail::inplace_block<T, RefCount, Alloc>;
+    using block_traits =
+        std::allocator_traits<typename block::block_allocator>;
+    using object_traits =
+        std::allocator_traits<typename block::object_allocator>;
+
+    typename block::block_allocator block_allocator(alloc);
+    block *new_block = block_traits::allocate(block_allocator, 1);
+    try {
+        block_traits::construct(block_allocator, new_block, alloc);
+    } catch (...) {
+        block_traits::deallocate(block_allocator, new_block, 1);
+        throw;
+    }
+    try {
+        object_traits::construct(
+            new_block->allocator, new_block->object(),
+            std::forward<Args>(args)...
+        );
+    } catch (...) {
+        block_traits::destroy(block_allocator, new_block);
+        block_traits::deallocate(block_allocator, new_block, 1);
+        throw;
+    }
+    return shared_ptr<T, RefCount>(
+        new_block->object(),
+        static_cast<detail::control_block<RefCount> *>(new_block)
+    );
+}
+
+// Creates the object and its control block with one allocation.
+template <typename T, typename RefCount = non_atomic_count, typename... Args>
+shared_ptr<T, RefCount> make_shared(Args &&...args) {
+    return allocate_shared<T, RefCount>(
+        std::allocator<T>(), std::forward<Args>(args)...
+    );
+}
 }  // namespace ptrs::shared
\ No newline at end of file
@@ -0,0 +1,173 @@
+// Copy/destroy throughput of ptrs::shared::shared_ptr under both reference
+// counting policies.
+//
+//     shared_ptr_benchmark [iterations] [max_threads]
+//
+// Every thread repeatedly copies a shared_ptr and destroys the copy. In the
+// "shared" scenario all threads copy the same pointer, so they contend on
+// one counter; in the "private" one each thread has its own object. The
+// non-atomic policy only runs single-threaded, as anything else would be a
+// data race. Reported is the mean time of one copy plus destroy.
+//
+// Beforehand, objects released through deferred_deleter are checked to be
+// destroyed by the reclaimer thread once flush() returns; if not, the
+// program exits with status 1. It also checks at compile time that
+// unique_ptr<T[]> refuses pointers to arrays of derived objects.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+#include "deferred_deleter.hpp"
+#include "shared_ptr.hpp"
+#include "unique_ptr.hpp"
+
+namespace {
+using ptrs::shared::atomic_count;
+using ptrs::shared::non_atomic_count;
+using ptrs::shared::shared_ptr;
+
+// Records the thread each object is destroyed on.
+struct tracked {
+    static inline std::mutex mutex;
+    static inline std::vector<std::thread::id> destroyed_on;
+
+    ~tracked() {
+        std::lock_guard<std::mutex> lock(mutex);
+        destroyed_on.push_back(std::this_thread::get_id());
+    }
+};
+
+struct derived_tracked : tracked {};
+
+// delete[] must see the type the array was created with.
+static_assert(
+    !std::is_constructible_v<
+        ptrs::unique::unique_ptr<tracked[]>,
+        derived_tracked *>,
+    "unique_ptr<T[]> must not adopt arrays of derived objects"
+);
+static_assert(
+    std::is_constructible_v<ptrs::unique::unique_ptr<tracked[]>, tracked *>
+);
+
+void check_deferred_deletion() {
+    using ptrs::deferred::deferred_deleter;
+    constexpr std::size_t OBJECTS = 100;
+    constexpr std::size_t ARRAY = 3;
+    for (std::size_t i = 0; i < OBJECTS; i++) {
+        shared_ptr<tracked>(new tracked, deferred_deleter<tracked>());
+        ptrs::unique::unique_ptr<tracked, deferred_deleter<tracked>>(
+            new tracked
+        );
+        ptrs::unique::unique_ptr<tracked[], deferred_deleter<tracked[]>>(
+            new tracked[ARRAY]
+        );
+    }
+    ptrs::deferred::flush();
+    std::lock_guard<std::mutex> lock(tracked::mutex);
+    const std::size_t expected = OBJECTS * (2 + ARRAY);
+    const bool off_thread = std::none_of(
+        tracked::destroyed_on.begin(), tracked::destroyed_on.end(),
+        [](std::thread::id id) { return id == std::this_thread::get_id(); }
+    );
+    if (tracked::destroyed_on.size() != expected || !off_thread) {
+        std::cout << "deferred deletion destroyed "
+                  << tracked::destroyed_on.size() << " of " << expected
+                  << " objects, " << (off_thread ? "all" : "not all")
+                  << " on the reclaimer thread\n";
+        std::exit(1);
+    }
+}
+
+template <typename RefCount>
+void copy_and_destroy(
+    const shared_ptr<int, RefCount> &source,
+    std::size_t iterations
+) {
+    for (std::size_t i = 0; i < iterations; i++) {
+        shared_ptr<int, RefCount> copy(source);
+        // Keeps the copy from being optimized away.
+        std::atomic_signal_fence(std::memory_order_seq_cst);
+    }
+}
+
+template <typename RefCount>
+double run(std::size_t threads, std::size_t iterations, bool contended) {
+    shared_ptr<int, RefCount> common(new int(42));
+    std::vector<shared_ptr<int, RefCount>> own;
+    for (std::size_t i = 0; i < threads; i++) {
+        own.emplace_back(new int(42));
+    }
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < threads; i++) {
+        workers.emplace_back([&, i] {
+            copy_and_destroy(contended ? common : own[i], iterations);
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    const double ns = std::chrono::duration<double, std::nano>(
+                          std::chrono::steady_clock::now() - start
+    )
+                          .count();
+    if (common.use_count() != 1) {
+        std::cout << "reference count is off: " << common.use_count()
+                  << "\n";
+        std::exit(1);
+    }
+    return ns / static_cast<double>(iterations * threads);
+}
+
+void report(
+    const std::string &policy,
+    const std::string &scenario,
+    std::size_t threads,
+    double ns
+) {
+    std::cout << std::left << std::setw(12) << policy << std::setw(10)
+              << scenario << std::right << std::setw(8) << threads
+              << std::setw(12) << std::fixed << std::setprecision(2) << ns
+              << "\n";
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t iterations =
+        argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 10000000;
+    const std::size_t max_threads =
+        argc > 2 ? std::strtoull(argv[2], nullptr, 10)
+                 : std::max(std::thread::hardware_concurrency(), 1U);
+
+    check_deferred_deletion();
+    std::cout << std::left << std::setw(12) << "policy" << std::setw(10)
+              << "scenario" << std::right << std::setw(8) << "threads"
+              << std::setw(12) << "ns/copy\n";
+    report(
+        "non-atomic", "private", 1,
+        run<non_atomic_count>(1, iterations, false)
+    );
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+        report(
+            "atomic", "private", threads,
+            run<atomic_count>(threads, iterations, false)
+        );
+        report(
+            "atomic", "shared", threads,
+            run<atomic_count>(threads, iterations, true)
+        );
+        if (threads < max_threads && threads * 2 > max_threads) {
+            threads = max_threads / 2;
+        }
+    }
+    return 0;
+}
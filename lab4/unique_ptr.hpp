@@ -1,100 +1,205 @@
-#pragma once
-
-#include <algorithm>
-#include <iostream>
-#include <utility>
-
-namespace ptrs::unique {
-template <typename T>
-struct Deleter {
-    void operator()(T *ptr) const {
-        delete ptr;
-    }
-};
-
-template <typename T, typename Deleter = Deleter<T>>
-class unique_ptr {
-    T *ptr = nullptr;
-    Deleter deleter;
-
-public:
-    unique_ptr() = default;
-
-    // cppcheck-suppress noExplicitConstructor
-    unique_ptr(std::nullptr_t) {
-    }
-
-    explicit unique_ptr(T *ptr) : ptr(ptr) {
-    }
-
-    explicit unique_ptr(T *ptr, const Deleter &deleter)
-        : ptr(ptr), deleter(deleter) {
-    }
-
-    explicit unique_ptr(T *ptr, Deleter &&deleter)
-        : ptr(ptr), deleter(std::move(deleter)) {
-    }
-
-    unique_ptr(const unique_ptr &) = delete;
-
-    unique_ptr(unique_ptr &&other)
-        : ptr(std::exchange(other.ptr, nullptr)),
-          deleter(std::move(other.deleter)) {
-    }
-
-    unique_ptr &operator=(const unique_ptr &) = delete;
-
-    unique_ptr &operator=(unique_ptr &&other) {
-        if (this != &other) {
-            reset(other.release());
-            deleter = std::move(other.deleter);
-        }
-        return *this;
-    }
-
-    ~unique_ptr() {
-        reset();
-    }
-
-    [[nodiscard]] T *get() const {
-        return ptr;
-    }
-
-    T &operator*() const {
-        return *ptr;
-    }
-
-    T *operator->() const {
-        return ptr;
-    }
-
-    explicit operator bool() const {
-        return ptr != nullptr;
-    }
-
-    T *release() {
-        return std::exchange(ptr, nullptr);
-    }
-
-    void reset(T *new_ptr = nullptr) {
-        if (ptr != nullptr) {
-            deleter(ptr);
-        }
-        ptr = new_ptr;
-    }
-
-    friend bool operator==(const unique_ptr &lhs, const unique_ptr &rhs) {
-        return lhs.ptr == rhs.ptr;
-    }
-
-    friend bool operator!=(const unique_ptr &lhs, const unique_ptr &rhs) {
-        return !(lhs == rhs);
-    }
-
-    friend void swap(unique_ptr &lhs, unique_ptr &rhs) {
-        std::swap(lhs.ptr, rhs.ptr);
-        std::swap(lhs.deleter, rhs.deleter);
-    }
-};
-
-}  // namespace ptrs::unique
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
+#include <type_traits>
+#include <utility>
+
+namespace ptrs::unique {
+template <typename T>
+struct Deleter {
+    void operator()(T *ptr) const {
+        delete ptr;
+    }
+};
+
+template <typename T>
+struct Deleter<T[]> {
+    void operator()(T *ptr) const {
+        delete[] ptr;
+    }
+};
+
+namespace detail {
+// Stores the deleter as an empty base when it has no state, so the pointer
+// stays one word wide.
+template <
+    typename Deleter,
+    bool Empty = std::is_empty_v<Deleter> && !std::is_final_v<Deleter>>
+class deleter_holder : private Deleter {
+protected:
+    deleter_holder() = default;
+
+    explicit deleter_holder(const Deleter &deleter) : Deleter(deleter) {
+    }
+
+    explicit deleter_holder(Deleter &&deleter) : Deleter(std::move(deleter)) {
+    }
+
+    Deleter &deleter() {
+        return *this;
+    }
+
+    const Deleter &deleter() const {
+        return *this;
+    }
+};
+
+template <typename Deleter>
+class deleter_holder<Deleter, false> {
+    Deleter m_deleter;
+
+protected:
+    deleter_holder() = default;
+
+    explicit deleter_holder(const Deleter &deleter) : m_deleter(deleter) {
+    }
+
+    explicit deleter_holder(Deleter &&deleter)
+        : m_deleter(std::move(deleter)) {
+    }
+
+    Deleter &deleter() {
+        return m_deleter;
+    }
+
+    const Deleter &deleter() const {
+        return m_deleter;
+    }
+};
+
+// Everything unique_ptr<T> and unique_ptr<T[]> have in common; T is the
+// element type.
+template <typename T, typename Deleter>
+class unique_ptr_base : private deleter_holder<Deleter> {
+    using holder = deleter_holder<Deleter>;
+
+    T *ptr = nullptr;
+
+public:
+    unique_ptr_base() = default;
+
+    // cppcheck-suppress noExplicitConstructor
+    unique_ptr_base(std::nullptr_t) {
+    }
+
+    explicit unique_ptr_base(T *ptr) : ptr(ptr) {
+    }
+
+    explicit unique_ptr_base(T *ptr, const Deleter &deleter)
+        : holder(deleter), ptr(ptr) {
+    }
+
+    explicit unique_ptr_base(T *ptr, Deleter &&deleter)
+        : holder(std::move(deleter)), ptr(ptr) {
+    }
+
+    unique_ptr_base(const unique_ptr_base &) = delete;
+
+    unique_ptr_base(unique_ptr_base &&other)
+        : holder(std::move(other.get_deleter())),
+          ptr(std::exchange(other.ptr, nullptr)) {
+    }
+
+    unique_ptr_base &operator=(const unique_ptr_base &) = delete;
+
+    unique_ptr_base &operator=(unique_ptr_base &&other) {
+        if (this != &other) {
+            reset(other.release());
+            get_deleter() = std::move(other.get_deleter());
+        }
+        return *this;
+    }
+
+    ~unique_ptr_base() {
+        reset();
+    }
+
+    [[nodiscard]] T *get() const {
+        return ptr;
+    }
+
+    Deleter &get_deleter() {
+        return holder::deleter();
+    }
+
+    const Deleter &get_deleter() const {
+        return holder::deleter();
+    }
+
+    explicit operator bool() const {
+        return ptr != nullptr;
+    }
+
+    T *release() {
+        return std::exchange(ptr, nullptr);
+    }
+
+    void reset(T *new_ptr = nullptr) {
+        if (ptr != nullptr) {
+            get_deleter()(ptr);
+        }
+        ptr = new_ptr;
+    }
+
+    friend bool
+    operator==(const unique_ptr_base &lhs, const unique_ptr_base &rhs) {
+        return lhs.ptr == rhs.ptr;
+    }
+
+    friend bool
+    operator!=(const unique_ptr_base &lhs, const unique_ptr_base &rhs) {
+        return !(lhs == rhs);
+    }
+
+    friend void swap(unique_ptr_base &lhs, unique_ptr_base &rhs) {
+        std::swap(lhs.ptr, rhs.ptr);
+        std::swap(lhs.get_deleter(), rhs.get_deleter());
+    }
+};
+}  // namespace detail
+
+template <typename T, typename Deleter = Deleter<T>>
+class unique_ptr : public detail::unique_ptr_base<T, Deleter> {
+public:
+    using detail::unique_ptr_base<T, Deleter>::unique_ptr_base;
+
+    T &operator*() const {
+        return *this->get();
+    }
+
+    T *operator->() const {
+        return this->get();
+    }
+};
+
+// Owns an array allocated with new[]; elements are reached with [].
+// Pointers to other types are rejected rather than converted: an array of
+// derived objects cannot be deleted through a pointer to its base.
+template <typename T, typename Deleter>
+class unique_ptr<T[], Deleter> : public detail::unique_ptr_base<T, Deleter> {
+    using base = detail::unique_ptr_base<T, Deleter>;
+
+public:
+    using base::base;
+    using base::reset;
+
+    template <typename U>
+    explicit unique_ptr(U *ptr) = delete;
+
+    template <typename U>
+    unique_ptr(U *ptr, const Deleter &deleter) = delete;
+
+    template <typename U>
+    unique_ptr(U *ptr, Deleter &&deleter) = delete;
+
+    template <typename U>
+    void reset(U *new_ptr) = delete;
+
+    T &operator[](std::size_t index) const {
+        return this->get()[index];
+    }
+};
+
+}  // namespace ptrs::unique
@@ -0,0 +1,234 @@
+#ifndef CONCURRENT_VECTOR_HPP_
+#define CONCURRENT_VECTOR_HPP_
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include "vector.hpp"
+
+namespace lab_vector_naive {
+// Append-only vector for many writer threads. push_back reserves an index
+// with a single fetch_add and constructs the element in place, so writers
+// never wait for each other. Elements live in segments of doubling size
+// that are never moved: segment k holds FIRST_SEGMENT_SIZE << k elements.
+// The thread that takes the first index of segment k installs segment k + 1
+// ahead of time, so other writers rarely find their segment missing; if
+// they do, they allocate it themselves and race to install it with a CAS.
+// Element addresses stay valid until the vector is destroyed or cleared.
+//
+// Readers may run alongside writers: for_each() visits the elements whose
+// construction has finished. operator[] may be used on an element once its
+// push_back has returned and that fact has been communicated to the
+// reader. If a constructor throws, its index is left as a permanent hole
+// that for_each() skips.
+template <typename T, typename Alloc = std::allocator<T>>
+class concurrent_vector {
+    using traits = std::allocator_traits<Alloc>;
+    using flag = std::atomic<bool>;
+
+    static constexpr size_t FIRST_SEGMENT_BITS = 5;
+    static constexpr size_t FIRST_SEGMENT_SIZE = size_t(1)
+                                                 << FIRST_SEGMENT_BITS;
+    static constexpr size_t MAX_SEGMENTS =
+        sizeof(size_t) * 8 - FIRST_SEGMENT_BITS;
+    // Keeps the contended counter away from the segment table.
+    static constexpr size_t CACHE_LINE = 64;
+
+    Alloc m_allocator;
+    std::array<std::atomic<T *>, MAX_SEGMENTS> m_segments{};
+    alignas(CACHE_LINE) std::atomic<size_t> m_size{0};
+
+    static size_t segment_size(size_t segment) VECTOR_NOEXCEPT {
+        return FIRST_SEGMENT_SIZE << segment;
+    }
+
+    // A segment is one allocation: the elements followed by one "ready"
+    // flag per element, so installing a segment only touches the flags.
+    static size_t allocation_size(size_t segment) VECTOR_NOEXCEPT {
+        const size_t size = segment_size(segment);
+        return size + (size * sizeof(flag) + sizeof(T) - 1) / sizeof(T);
+    }
+
+    static flag *ready_flags(T *data, size_t segment) VECTOR_NOEXCEPT {
+        return reinterpret_cast<flag *>(data + segment_size(segment));
+    }
+
+    static const flag *
+    ready_flags(const T *data, size_t segment) VECTOR_NOEXCEPT {
+        return reinterpret_cast<const flag *>(data + segment_size(segment));
+    }
+
+    static size_t highest_bit(size_t value) VECTOR_NOEXCEPT {
+#if defined(__GNUC__)
+        return sizeof(unsigned long long) * 8 - 1 -
+               static_cast<size_t>(__builtin_clzll(value));
+#else
+        size_t result = 0;
+        while (value >>= 1) {
+            ++result;
+        }
+        return result;
+#endif
+    }
+
+    // Index i lives in segment k at offset o where
+    // i + FIRST_SEGMENT_SIZE == (FIRST_SEGMENT_SIZE << k) + o.
+    static std::pair<size_t, size_t> locate(size_t index) VECTOR_NOEXCEPT {
+        const size_t biased = index + FIRST_SEGMENT_SIZE;
+        const size_t segment = highest_bit(biased) - FIRST_SEGMENT_BITS;
+        return {segment, biased - segment_size(segment)};
+    }
+
+    T *install_segment(size_t segment) {
+        T *fresh = traits::allocate(m_allocator, allocation_size(segment));
+        flag *flags = ready_flags(fresh, segment);
+        for (size_t i = 0; i < segment_size(segment); ++i) {
+            new (flags + i) flag(false);
+        }
+        T *expected = nullptr;
+        if (m_segments[segment].compare_exchange_strong(
+                expected, fresh, std::memory_order_acq_rel,
+                std::memory_order_acquire
+            )) {
+            return fresh;
+        }
+        // Another thread won the race; use its segment.
+        traits::deallocate(m_allocator, fresh, allocation_size(segment));
+        return expected;
+    }
+
+    T *segment_data(size_t segment) {
+        T *data = m_segments[segment].load(std::memory_order_acquire);
+        return data != nullptr ? data : install_segment(segment);
+    }
+
+    const T *find_segment(size_t segment) const VECTOR_NOEXCEPT {
+        return m_segments[segment].load(std::memory_order_acquire);
+    }
+
+public:
+    concurrent_vector() = default;
+
+    explicit concurrent_vector(const Alloc &alloc) : m_allocator(alloc) {
+    }
+
+    concurrent_vector(const concurrent_vector &) = delete;
+
+    concurrent_vector(concurrent_vector &&) = delete;
+
+    concurrent_vector &operator=(const concurrent_vector &) = delete;
+
+    concurrent_vector &operator=(concurrent_vector &&) = delete;
+
+    ~concurrent_vector() {
+        clear();
+    }
+
+    // Constructs a new element from args and returns its index. Safe to call
+    // from any number of threads at once.
+    template <typename... Args>
+    size_t emplace_back(Args &&...args) {
+        const size_t index = m_size.fetch_add(1, std::memory_order_relaxed);
+        auto [segment, offset] = locate(index);
+        if (offset == 0 && segment + 1 < MAX_SEGMENTS) {
+            segment_data(segment + 1);
+        }
+        T *data = segment_data(segment);
+        new (data + offset) T(std::forward<Args>(args)...);
+        ready_flags(data, segment)[offset].store(
+            true, std::memory_order_release
+        );
+        return index;
+    }
+
+    size_t push_back(const T &value) {
+        return emplace_back(value);
+    }
+
+    size_t push_back(T &&value) {
+        return emplace_back(std::move(value));
+    }
+
+    // Number of indices handed out so far, including elements that are
+    // still being constructed.
+    [[nodiscard]] size_t size() const VECTOR_NOEXCEPT {
+        return m_size.load(std::memory_order_acquire);
+    }
+
+    [[nodiscard]] bool empty() const VECTOR_NOEXCEPT {
+        return size() == 0;
+    }
+
+    // Whether the element at index is fully constructed and visible.
+    [[nodiscard]] bool ready(size_t index) const VECTOR_NOEXCEPT {
+        auto [segment, offset] = locate(index);
+        const T *data = find_segment(segment);
+        return data != nullptr && ready_flags(data, segment)[offset].load(
+                                      std::memory_order_acquire
+                                  );
+    }
+
+    T &operator[](size_t index) {
+        auto [segment, offset] = locate(index);
+        return m_segments[segment].load(std::memory_order_acquire)[offset];
+    }
+
+    const T &operator[](size_t index) const {
+        auto [segment, offset] = locate(index);
+        return find_segment(segment)[offset];
+    }
+
+    T &at(size_t index) {
+        if (!ready(index)) {
+            throw std::out_of_range("Index is out of range");
+        }
+        return (*this)[index];
+    }
+
+    const T &at(size_t index) const {
+        if (!ready(index)) {
+            throw std::out_of_range("Index is out of range");
+        }
+        return (*this)[index];
+    }
+
+    // Calls f(index, element) for every finished element, in index order.
+    // Safe to call while other threads append.
+    template <typename F>
+    void for_each(F f) const {
+        const size_t count = size();
+        for (size_t i = 0; i < count; ++i) {
+            if (ready(i)) {
+                f(i, (*this)[i]);
+            }
+        }
+    }
+
+    // Destroys all elements and frees the segments. Must not run
+    // concurrently with any other member function.
+    void clear() VECTOR_NOEXCEPT {
+        for (size_t segment = 0; segment < MAX_SEGMENTS; ++segment) {
+            T *data = m_segments[segment].exchange(
+                nullptr, std::memory_order_relaxed
+            );
+            if (data == nullptr) {
+                continue;
+            }
+            flag *flags = ready_flags(data, segment);
+            for (size_t i = 0; i < segment_size(segment); ++i) {
+                if (flags[i].load(std::memory_order_relaxed)) {
+                    data[i].~T();
+                }
+            }
+            traits::deallocate(m_allocator, data, allocation_size(segment));
+        }
+        m_size.store(0, std::memory_order_relaxed);
+    }
+};
+}  // namespace lab_vector_naive
+
+#endif  // CONCURRENT_VECTOR_HPP_
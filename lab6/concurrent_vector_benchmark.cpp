@@ -0,0 +1,139 @@
+// Appends from many threads: concurrent_vector against a mutex-protected
+// lab_vector_naive::vector.
+//
+//     concurrent_vector_benchmark [elements] [max_threads]
+//
+// For every thread count from 1 up to max_threads (the hardware concurrency
+// by default) each thread appends elements / threads integers. The results
+// are checked to contain every value exactly once, then the wall time and
+// throughput of both containers are printed.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "concurrent_vector.hpp"
+#include "vector.hpp"
+
+namespace {
+using lab_vector_naive::concurrent_vector;
+
+// Runs body(thread_index) on `threads` threads and returns the wall time in
+// milliseconds.
+double run_threads(
+    std::size_t threads,
+    const std::function<void(std::size_t)> &body
+) {
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < threads; i++) {
+        workers.emplace_back(body, i);
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    return std::chrono::duration<double, std::milli>(
+               std::chrono::steady_clock::now() - start
+    )
+        .count();
+}
+
+bool holds_every_value(std::vector<std::size_t> values, std::size_t count) {
+    if (values.size() != count) {
+        return false;
+    }
+    std::sort(values.begin(), values.end());
+    for (std::size_t i = 0; i < count; i++) {
+        if (values[i] != i) {
+            return false;
+        }
+    }
+    return true;
+}
+
+double concurrent_append(std::size_t elements, std::size_t threads, bool &ok) {
+    concurrent_vector<std::size_t> result;
+    const std::size_t per_thread = elements / threads;
+    const double ms = run_threads(threads, [&](std::size_t thread) {
+        for (std::size_t i = 0; i < per_thread; i++) {
+            result.push_back(thread * per_thread + i);
+        }
+    });
+    std::vector<std::size_t> values;
+    result.for_each([&](std::size_t, std::size_t value) {
+        values.push_back(value);
+    });
+    ok = holds_every_value(std::move(values), per_thread * threads);
+    return ms;
+}
+
+double locked_append(std::size_t elements, std::size_t threads, bool &ok) {
+    lab_vector_naive::vector<std::size_t> result;
+    std::mutex mutex;
+    const std::size_t per_thread = elements / threads;
+    const double ms = run_threads(threads, [&](std::size_t thread) {
+        for (std::size_t i = 0; i < per_thread; i++) {
+            std::lock_guard<std::mutex> lock(mutex);
+            result.push_back(thread * per_thread + i);
+        }
+    });
+    ok = holds_every_value(
+        std::vector<std::size_t>(result.begin(), result.end()),
+        per_thread * threads
+    );
+    return ms;
+}
+
+void report(
+    const char *name,
+    std::size_t threads,
+    std::size_t elements,
+    double ms
+) {
+    std::cout << std::left << std::setw(20) << name << std::right
+              << std::setw(8) << threads << std::setw(12) << std::fixed
+              << std::setprecision(1) << ms << std::setw(14)
+              << static_cast<double>(elements) / ms / 1000.0 << "\n";
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t elements =
+        argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 20000000;
+    const std::size_t max_threads =
+        argc > 2 ? std::strtoull(argv[2], nullptr, 10)
+                 : std::max(std::thread::hardware_concurrency(), 1U);
+
+    std::cout << std::left << std::setw(20) << "container" << std::right
+              << std::setw(8) << "threads" << std::setw(12) << "ms"
+              << std::setw(14) << "Mpush/s\n";
+    for (std::size_t threads = 1; threads <= max_threads; threads *= 2) {
+        const std::size_t pushed = elements / threads * threads;
+        bool ok = false;
+        report(
+            "concurrent_vector", threads, pushed,
+            concurrent_append(elements, threads, ok)
+        );
+        if (!ok) {
+            std::cout << "concurrent_vector lost or duplicated elements\n";
+            return 1;
+        }
+        report(
+            "mutex + vector", threads, pushed,
+            locked_append(elements, threads, ok)
+        );
+        if (!ok) {
+            std::cout << "mutex + vector lost or duplicated elements\n";
+            return 1;
+        }
+        if (threads < max_threads && threads * 2 > max_threads) {
+            threads = max_threads / 2;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+#ifndef MALLOC_ALLOCATOR_HPP_
+#define MALLOC_ALLOCATOR_HPP_
+
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <new>
+
+namespace lab_vector_naive {
+// Allocator on top of malloc/free. Its reallocate() goes through realloc,
+// which can often extend a block in place; vector uses it to grow buffers
+// of trivially relocatable elements without copying them.
+template <typename T>
+struct malloc_allocator {
+    static_assert(
+        alignof(T) <= alignof(std::max_align_t),
+        "malloc does not support over-aligned types"
+    );
+
+    using value_type = T;
+
+    malloc_allocator() = default;
+
+    template <typename U>
+    // cppcheck-suppress noExplicitConstructor
+    malloc_allocator(const malloc_allocator<U> &) noexcept {
+    }
+
+    static T *allocate(std::size_t count) {
+        return checked(std::malloc(bytes_for(count)));
+    }
+
+    static void deallocate(T *data, std::size_t) noexcept {
+        std::free(data);
+    }
+
+    // On failure throws std::bad_alloc and leaves data untouched.
+    static T *reallocate(T *data, std::size_t, std::size_t new_count) {
+        return checked(std::realloc(data, bytes_for(new_count)));
+    }
+
+    friend bool operator==(const malloc_allocator &, const malloc_allocator &) {
+        return true;
+    }
+
+    friend bool operator!=(const malloc_allocator &, const malloc_allocator &) {
+        return false;
+    }
+
+private:
+    static std::size_t bytes_for(std::size_t count) {
+        if (count > std::numeric_limits<std::size_t>::max() / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return count * sizeof(T);
+    }
+
+    static T *checked(void *result) {
+        if (result == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<T *>(result);
+    }
+};
+}  // namespace lab_vector_naive
+
+#endif  // MALLOC_ALLOCATOR_HPP_
@@ -0,0 +1,173 @@
+#ifndef MMAP_ALLOCATOR_HPP_
+#define MMAP_ALLOCATOR_HPP_
+
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+namespace lab_vector_naive {
+// Allocator for very large vectors. Every block reserves a range of address
+// space up front (PROT_NONE, so it costs no memory) and only the pages in
+// use are made accessible. expand_in_place() commits more of the range, so a
+// vector using this allocator grows without moving its elements or holding
+// two buffers at once until the reservation runs out. By default a block
+// reserves RESERVATION_FACTOR times the requested size within fixed bounds,
+// so growth past it moves the elements only a logarithmic number of times.
+// Optionally the range is marked for transparent huge pages to cut TLB
+// misses. Blocks describe themselves in a header, so any instance can free
+// any block.
+template <typename T>
+class mmap_allocator {
+    template <typename U>
+    friend class mmap_allocator;
+
+    // Sits in front of the elements; its size keeps them cache line
+    // aligned.
+    struct alignas(64) header {
+        size_t reserved;
+        size_t committed;
+    };
+
+    static_assert(
+        alignof(T) <= alignof(header), "Elements must fit the header alignment"
+    );
+
+    static constexpr size_t RESERVATION_FACTOR = 16;
+    static constexpr size_t MIN_RESERVATION = size_t(1) << 21;
+    static constexpr size_t MAX_RESERVATION = size_t(1) << 34;
+
+    // Zero scales the reservation with the requested size.
+    size_t m_reservation = 0;
+    bool m_huge_pages = false;
+
+    static size_t page_size() {
+        static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        return size;
+    }
+
+    static size_t round_to_pages(size_t bytes) {
+        return (bytes + page_size() - 1) / page_size() * page_size();
+    }
+
+    static size_t bytes_for(size_t count) {
+        if (count > (size_t(-1) - sizeof(header) - page_size()) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return round_to_pages(sizeof(header) + count * sizeof(T));
+    }
+
+    size_t reservation_for(size_t bytes) const {
+        size_t reservation = round_to_pages(m_reservation);
+        if (m_reservation == 0) {
+            reservation = bytes < MAX_RESERVATION / RESERVATION_FACTOR
+                              ? bytes * RESERVATION_FACTOR
+                              : MAX_RESERVATION;
+            if (reservation < MIN_RESERVATION) {
+                reservation = MIN_RESERVATION;
+            }
+        }
+        return reservation > bytes ? reservation : bytes;
+    }
+
+    static void *reserve(size_t bytes) {
+        void *range = mmap(
+            nullptr, bytes, PROT_NONE,
+            MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0
+        );
+        return range == MAP_FAILED ? nullptr : range;
+    }
+
+    static header *header_of(T *data) {
+        return reinterpret_cast<header *>(data) - 1;
+    }
+
+    static bool commit(header *block, size_t bytes) {
+        return mprotect(block, bytes, PROT_READ | PROT_WRITE) == 0;
+    }
+
+public:
+    using value_type = T;
+    using propagate_on_container_copy_assignment = std::true_type;
+    using propagate_on_container_move_assignment = std::true_type;
+    using propagate_on_container_swap = std::true_type;
+    using is_always_equal = std::true_type;
+
+    mmap_allocator() = default;
+
+    // Each block reserves at least `reservation` bytes of address space
+    // instead of a multiple of its size.
+    explicit mmap_allocator(size_t reservation, bool huge_pages = false)
+        : m_reservation(reservation), m_huge_pages(huge_pages) {
+    }
+
+    template <typename U>
+    // cppcheck-suppress noExplicitConstructor
+    mmap_allocator(const mmap_allocator<U> &other) noexcept
+        : m_reservation(other.m_reservation),
+          m_huge_pages(other.m_huge_pages) {
+    }
+
+    T *allocate(size_t count) {
+        const size_t bytes = bytes_for(count);
+        size_t reserved = reservation_for(bytes);
+        void *range = reserve(reserved);
+        if (range == nullptr && reserved > bytes) {
+            // Address space may be limited (ulimit -v); the block can still
+            // be served, it just cannot grow in place.
+            reserved = bytes;
+            range = reserve(reserved);
+        }
+        if (range == nullptr) {
+            throw std::bad_alloc();
+        }
+#ifdef MADV_HUGEPAGE
+        if (m_huge_pages) {
+            // Only a hint: the kernel may lack THP support.
+            madvise(range, reserved, MADV_HUGEPAGE);
+        }
+#endif
+        header *block = static_cast<header *>(range);
+        if (!commit(block, bytes)) {
+            munmap(range, reserved);
+            throw std::bad_alloc();
+        }
+        block->reserved = reserved;
+        block->committed = bytes;
+        return reinterpret_cast<T *>(block + 1);
+    }
+
+    static void deallocate(T *data, size_t) noexcept {
+        header *block = header_of(data);
+        munmap(block, block->reserved);
+    }
+
+    // Makes room for new_count elements at data; false if the reservation
+    // is too small or the pages cannot be committed.
+    static bool expand_in_place(T *data, size_t, size_t new_count) {
+        header *block = header_of(data);
+        const size_t bytes = bytes_for(new_count);
+        if (bytes > block->reserved) {
+            return false;
+        }
+        if (bytes > block->committed) {
+            if (!commit(block, bytes)) {
+                return false;
+            }
+            block->committed = bytes;
+        }
+        return true;
+    }
+
+    friend bool operator==(const mmap_allocator &, const mmap_allocator &) {
+        return true;
+    }
+
+    friend bool operator!=(const mmap_allocator &, const mmap_allocator &) {
+        return false;
+    }
+};
+}  // namespace lab_vector_naive
+
+#endif  // MMAP_ALLOCATOR_HPP_
@@ -0,0 +1,21 @@
+#ifndef SMALL_VECTOR_HPP_
+#define SMALL_VECTOR_HPP_
+
+#include <memory>
+#include "vector.hpp"
+
+namespace lab_vector_naive {
+// Vector that keeps up to N elements inside the object and only allocates
+// once it grows past them. It is lab_vector_naive::vector itself, so
+// growth, resize and copy assignment keep the same guarantees; moving or
+// swapping small vectors moves their elements, as their storage cannot be
+// handed over.
+template <
+    typename T,
+    size_t N,
+    typename Alloc = std::allocator<T>,
+    typename Growth = power_of_two_growth>
+using small_vector = vector<T, Alloc, Growth, N>;
+}  // namespace lab_vector_naive
+
+#endif  // SMALL_VECTOR_HPP_
@@ -0,0 +1,475 @@
+#ifndef SOA_VECTOR_HPP_
+#define SOA_VECTOR_HPP_
+
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "vector.hpp"
+
+namespace lab_vector_naive {
+// Contiguous run of one field of an soa_vector.
+template <typename T>
+class field_span {
+    T *m_data = nullptr;
+    size_t m_size = 0;
+
+public:
+    field_span(T *data, size_t size) VECTOR_NOEXCEPT : m_data(data),
+                                                       m_size(size) {
+    }
+
+    [[nodiscard]] T *data() const VECTOR_NOEXCEPT {
+        return m_data;
+    }
+
+    [[nodiscard]] size_t size() const VECTOR_NOEXCEPT {
+        return m_size;
+    }
+
+    [[nodiscard]] bool empty() const VECTOR_NOEXCEPT {
+        return m_size == 0;
+    }
+
+    T &operator[](size_t index) const {
+        return m_data[index];
+    }
+
+    T *begin() const VECTOR_NOEXCEPT {
+        return m_data;
+    }
+
+    T *end() const VECTOR_NOEXCEPT {
+        return m_data + m_size;
+    }
+};
+
+// Structure-of-arrays vector: element i is the tuple of the i-th values of
+// several fields, and every field lives in its own buffer, so a loop over
+// one field (field<I>()) scans contiguous memory and vectorizes. All
+// buffers share one size and capacity and grow together, with the same
+// strong guarantees as lab_vector_naive::vector. Elements are accessed
+// through proxies: operator[] returns a std::tuple of references to the
+// fields, which works with std::get, structured bindings and assignment
+// from a tuple of values.
+template <typename... Fields>
+class soa_vector {
+    static_assert(sizeof...(Fields) > 0, "soa_vector needs a field");
+
+    using indices = std::index_sequence_for<Fields...>;
+    using buffers = std::tuple<Fields *...>;
+
+    template <size_t I>
+    using field_type = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+    static constexpr size_t FIELDS = sizeof...(Fields);
+
+    // Relocation may only move the fields if none of them can throw:
+    // otherwise a later field failing would leave the earlier ones moved
+    // from. Fields that cannot be copied are moved regardless.
+    static constexpr bool NOTHROW_RELOCATE =
+        ((is_trivially_relocatable_v<Fields> ||
+          std::is_nothrow_move_constructible_v<Fields>) &&
+         ...);
+
+    size_t m_capacity = 0;
+    size_t m_size = 0;
+    buffers m_data{};
+
+    void check_index_is_in_range(size_t index) const {
+        if (index >= m_size) {
+            throw std::out_of_range("Index is out of range");
+        }
+    }
+
+    template <size_t... I>
+    static void allocate_each(
+        buffers &data,
+        size_t capacity,
+        std::index_sequence<I...>
+    ) {
+        ((std::get<I>(data) = std::allocator<Fields>().allocate(capacity)),
+         ...);
+    }
+
+    template <size_t... I>
+    static void deallocate_each(
+        const buffers &data,
+        size_t capacity,
+        std::index_sequence<I...>
+    ) VECTOR_NOEXCEPT {
+        ((std::get<I>(data) != nullptr
+              ? std::allocator<Fields>().deallocate(std::get<I>(data), capacity)
+              : void()),
+         ...);
+    }
+
+    static void deallocate(const buffers &data, size_t capacity)
+        VECTOR_NOEXCEPT {
+        deallocate_each(data, capacity, indices{});
+    }
+
+    // One buffer per field, all or nothing.
+    static buffers allocate(size_t capacity) {
+        buffers data{};
+        if (capacity == 0) {
+            return data;
+        }
+        try {
+            allocate_each(data, capacity, indices{});
+        } catch (...) {
+            deallocate(data, capacity);
+            throw;
+        }
+        return data;
+    }
+
+    template <size_t... I>
+    static void destroy_each(
+        const buffers &data,
+        size_t index,
+        std::index_sequence<I...>
+    ) VECTOR_NOEXCEPT {
+        (std::get<I>(data)[index].~Fields(), ...);
+    }
+
+    static void destroy(const buffers &data, size_t first, size_t last)
+        VECTOR_NOEXCEPT {
+        for (; first != last; ++first) {
+            destroy_each(data, first, indices{});
+        }
+    }
+
+    // Constructs every field of element `index`, field I with
+    // make(std::integral_constant<size_t, I>(), pointer, index). If one
+    // throws, the fields already built are destroyed.
+    template <size_t I = 0, typename Make>
+    static void construct(const buffers &data, size_t index, Make &make) {
+        field_type<I> *where = std::get<I>(data) + index;
+        make(std::integral_constant<size_t, I>(), where, index);
+        if constexpr (I + 1 < FIELDS) {
+            try {
+                construct<I + 1>(data, index, make);
+            } catch (...) {
+                where->~field_type<I>();
+                throw;
+            }
+        }
+    }
+
+    // Constructs elements [first, last) of data. On failure the ones built
+    // so far are destroyed.
+    template <typename Make>
+    static void construct_range(
+        const buffers &data,
+        size_t first,
+        size_t last,
+        Make &make
+    ) {
+        size_t i = first;
+        try {
+            for (; i < last; ++i) {
+                construct(data, i, make);
+            }
+        } catch (...) {
+            destroy(data, first, i);
+            throw;
+        }
+    }
+
+    template <typename T>
+    static void relocate_field(T *from, T *to, size_t count) {
+        if constexpr (is_trivially_relocatable_v<T>) {
+            if (count != 0) {
+                std::memcpy(
+                    static_cast<void *>(to), static_cast<const void *>(from),
+                    count * sizeof(T)
+                );
+            }
+        } else {
+            size_t i = 0;
+            try {
+                for (; i < count; ++i) {
+                    if constexpr (NOTHROW_RELOCATE ||
+                                  !std::is_copy_constructible_v<T>) {
+                        new (to + i) T(std::move(from[i]));
+                    } else {
+                        new (to + i) T(static_cast<const T &>(from[i]));
+                    }
+                }
+            } catch (...) {
+                for (size_t j = 0; j < i; ++j) {
+                    to[j].~T();
+                }
+                throw;
+            }
+        }
+    }
+
+    // Copies or moves the first m_size elements of every field to `to`. On
+    // failure `to` holds nothing and the elements are where they were.
+    template <size_t I = 0>
+    void relocate(const buffers &to) {
+        using T = field_type<I>;
+        relocate_field(std::get<I>(m_data), std::get<I>(to), m_size);
+        if constexpr (I + 1 < FIELDS) {
+            try {
+                relocate<I + 1>(to);
+            } catch (...) {
+                if constexpr (!is_trivially_relocatable_v<T>) {
+                    for (size_t i = 0; i < m_size; ++i) {
+                        std::get<I>(to)[i].~T();
+                    }
+                }
+                throw;
+            }
+        }
+    }
+
+    template <size_t... I>
+    void destroy_relocated(std::index_sequence<I...>) VECTOR_NOEXCEPT {
+        (destroy_relocated_field(std::get<I>(m_data)), ...);
+    }
+
+    template <typename T>
+    void destroy_relocated_field(T *data) VECTOR_NOEXCEPT {
+        if constexpr (!is_trivially_relocatable_v<T>) {
+            for (size_t i = 0; i < m_size; ++i) {
+                data[i].~T();
+            }
+        }
+    }
+
+    void adopt(const buffers &data, size_t capacity) VECTOR_NOEXCEPT {
+        destroy_relocated(indices{});
+        deallocate(m_data, m_capacity);
+        m_data = data;
+        m_capacity = capacity;
+    }
+
+    // Moves the elements into buffers of new_capacity >= m_size elements.
+    // Strong guarantee.
+    void reallocate(size_t new_capacity) {
+        const buffers new_data = allocate(new_capacity);
+        try {
+            relocate(new_data);
+        } catch (...) {
+            deallocate(new_data, new_capacity);
+            throw;
+        }
+        adopt(new_data, new_capacity);
+    }
+
+    // Grows to new_size elements built with `make` (see construct()). New
+    // elements are built before the old ones are relocated, so they may be
+    // copies of existing ones. Strong guarantee.
+    template <typename Make>
+    void grow(size_t new_size, Make make) {
+        if (new_size <= m_capacity) {
+            construct_range(m_data, m_size, new_size, make);
+            m_size = new_size;
+            return;
+        }
+        const size_t new_capacity =
+            power_of_two_growth::next_capacity(m_capacity, new_size);
+        const buffers new_data = allocate(new_capacity);
+        try {
+            construct_range(new_data, m_size, new_size, make);
+            try {
+                relocate(new_data);
+            } catch (...) {
+                destroy(new_data, m_size, new_size);
+                throw;
+            }
+        } catch (...) {
+            deallocate(new_data, new_capacity);
+            throw;
+        }
+        adopt(new_data, new_capacity);
+        m_size = new_size;
+    }
+
+    template <size_t... I>
+    std::tuple<Fields &...> element(size_t index, std::index_sequence<I...>) {
+        return {std::get<I>(m_data)[index]...};
+    }
+
+    template <size_t... I>
+    std::tuple<const Fields &...>
+    element(size_t index, std::index_sequence<I...>) const {
+        return {std::get<I>(m_data)[index]...};
+    }
+
+public:
+    using value_type = std::tuple<Fields...>;
+    using reference = std::tuple<Fields &...>;
+    using const_reference = std::tuple<const Fields &...>;
+
+    soa_vector() = default;
+
+    explicit soa_vector(size_t size)
+        : m_capacity(power_of_two_growth::next_capacity(0, size)),
+          m_data(allocate(m_capacity)) {
+        auto make = [](auto field, auto *where, size_t) {
+            using T = field_type<decltype(field)::value>;
+            new (where) T();
+        };
+        try {
+            construct_range(m_data, 0, size, make);
+        } catch (...) {
+            deallocate(m_data, m_capacity);
+            throw;
+        }
+        m_size = size;
+    }
+
+    soa_vector(const soa_vector &other)
+        : m_capacity(power_of_two_growth::next_capacity(0, other.m_size)),
+          m_data(allocate(m_capacity)) {
+        auto make = [&](auto field, auto *where, size_t index) {
+            constexpr size_t I = decltype(field)::value;
+            new (where) field_type<I>(std::get<I>(other.m_data)[index]);
+        };
+        try {
+            construct_range(m_data, 0, other.m_size, make);
+        } catch (...) {
+            deallocate(m_data, m_capacity);
+            throw;
+        }
+        m_size = other.m_size;
+    }
+
+    soa_vector(soa_vector &&other) VECTOR_NOEXCEPT
+        : m_capacity(std::exchange(other.m_capacity, 0)),
+          m_size(std::exchange(other.m_size, 0)),
+          m_data(std::exchange(other.m_data, buffers{})) {
+    }
+
+    soa_vector &operator=(const soa_vector &other) {
+        if (this != &other) {
+            soa_vector tmp(other);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    soa_vector &operator=(soa_vector &&other) VECTOR_NOEXCEPT {
+        if (this != &other) {
+            soa_vector tmp(std::move(other));
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    ~soa_vector() VECTOR_NOEXCEPT {
+        clear();
+        deallocate(m_data, m_capacity);
+    }
+
+    void swap(soa_vector &other) VECTOR_NOEXCEPT {
+        std::swap(m_capacity, other.m_capacity);
+        std::swap(m_size, other.m_size);
+        std::swap(m_data, other.m_data);
+    }
+
+    friend void swap(soa_vector &lhs, soa_vector &rhs) VECTOR_NOEXCEPT {
+        lhs.swap(rhs);
+    }
+
+    [[nodiscard]] size_t size() const VECTOR_NOEXCEPT {
+        return m_size;
+    }
+
+    [[nodiscard]] size_t capacity() const VECTOR_NOEXCEPT {
+        return m_capacity;
+    }
+
+    [[nodiscard]] bool empty() const VECTOR_NOEXCEPT {
+        return m_size == 0;
+    }
+
+    void clear() VECTOR_NOEXCEPT {
+        destroy(m_data, 0, m_size);
+        m_size = 0;
+    }
+
+    // Appends an element built from one argument per field.
+    template <typename... Args>
+    void emplace_back(Args &&...args) {
+        static_assert(sizeof...(Args) == FIELDS, "One argument per field");
+        auto arguments = std::forward_as_tuple(std::forward<Args>(args)...);
+        auto make = [&](auto field, auto *where, size_t) {
+            using T = field_type<decltype(field)::value>;
+            new (where) T(std::get<decltype(field)::value>(std::move(arguments))
+            );
+        };
+        grow(m_size + 1, make);
+    }
+
+    void push_back(const Fields &...values) {
+        emplace_back(values...);
+    }
+
+    void push_back(const value_type &value) {
+        std::apply(
+            [this](const Fields &...values) { emplace_back(values...); }, value
+        );
+    }
+
+    void pop_back() {
+        destroy(m_data, m_size - 1, m_size);
+        --m_size;
+    }
+
+    void resize(size_t new_size) {
+        if (new_size <= m_size) {
+            destroy(m_data, new_size, m_size);
+            m_size = new_size;
+            return;
+        }
+        grow(new_size, [](auto field, auto *where, size_t) {
+            using T = field_type<decltype(field)::value>;
+            new (where) T();
+        });
+    }
+
+    void reserve(size_t new_capacity) {
+        if (new_capacity > m_capacity) {
+            reallocate(new_capacity);
+        }
+    }
+
+    reference operator[](size_t index) {
+        return element(index, indices{});
+    }
+
+    const_reference operator[](size_t index) const {
+        return element(index, indices{});
+    }
+
+    reference at(size_t index) {
+        check_index_is_in_range(index);
+        return element(index, indices{});
+    }
+
+    const_reference at(size_t index) const {
+        check_index_is_in_range(index);
+        return element(index, indices{});
+    }
+
+    // All values of field I, for loops that touch only that field.
+    template <size_t I>
+    field_span<field_type<I>> field() VECTOR_NOEXCEPT {
+        return {std::get<I>(m_data), m_size};
+    }
+
+    template <size_t I>
+    field_span<const field_type<I>> field() const VECTOR_NOEXCEPT {
+        return {std::get<I>(m_data), m_size};
+    }
+};
+}  // namespace lab_vector_naive
+
+#endif  // SOA_VECTOR_HPP_
@@ -1,18 +1,192 @@
 #ifndef VECTOR_HPP_
 #define VECTOR_HPP_
 
+#include <algorithm>
+#include <cstring>
 #include <exception>
+#include <functional>
+#include <initializer_list>
 #include <memory>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
 #include "vector_config.hpp"
 
 namespace lab_vector_naive {
-template <typename T, typename Alloc = std::allocator<T>>
-class vector {
-    size_t m_capacity = 0;
+// Growth policies pick the capacity to reallocate to when `required`
+// elements no longer fit into `current`.
+struct power_of_two_growth {
+    static size_t next_capacity(size_t current, size_t required)
+        VECTOR_NOEXCEPT {
+        static_cast<void>(current);
+        if (required == 0) {
+            return 0;
+        }
+        size_t result = required - 1;
+        for (size_t shift = 1; shift < sizeof(size_t) * 8; shift <<= 1) {
+            result |= result >> shift;
+        }
+        return result + 1;
+    }
+};
+
+template <size_t Numerator, size_t Denominator>
+struct factor_growth {
+    static_assert(Numerator > Denominator, "Growth factor must exceed 1");
+
+    static size_t next_capacity(size_t current, size_t required)
+        VECTOR_NOEXCEPT {
+        return std::max(required, current / Denominator * Numerator);
+    }
+};
+
+using golden_growth = factor_growth<3, 2>;
+using doubling_growth = factor_growth<2, 1>;
+
+// Types whose objects can be moved to another address with memcpy, the
+// source then being treated as gone without running its destructor. True
+// for trivially copyable types; specialize it for other types with that
+// property (e.g. ones holding only owning pointers to the heap).
+template <typename T>
+struct is_trivially_relocatable : std::is_trivially_copyable<T> {};
+
+template <typename T>
+constexpr bool is_trivially_relocatable_v = is_trivially_relocatable<T>::value;
+
+namespace detail {
+// Carries the VECTOR_NOEXCEPT setting into noexcept expressions.
+void vector_noexcept_probe() VECTOR_NOEXCEPT;
+
+// Allocators may provide T *reallocate(T *data, size_t old_capacity,
+// size_t new_capacity) with realloc semantics: the contents are moved
+// bitwise, possibly in place, and data is left valid if it throws.
+template <typename Alloc, typename T, typename = void>
+struct has_reallocate : std::false_type {};
+
+template <typename Alloc, typename T>
+struct has_reallocate<
+    Alloc,
+    T,
+    std::void_t<decltype(std::declval<Alloc &>().reallocate(
+        std::declval<T *>(),
+        size_t(),
+        size_t()
+    ))>> : std::true_type {};
+
+// Allocators may provide bool expand_in_place(T *data, size_t old_capacity,
+// size_t new_capacity) that enlarges a block without moving it, or returns
+// false and leaves it alone.
+template <typename Alloc, typename T, typename = void>
+struct has_expand_in_place : std::false_type {};
+
+template <typename Alloc, typename T>
+struct has_expand_in_place<
+    Alloc,
+    T,
+    std::void_t<decltype(std::declval<Alloc &>().expand_in_place(
+        std::declval<T *>(),
+        size_t(),
+        size_t()
+    ))>> : std::true_type {};
+
+// Holds the allocator of a container. Empty allocators become an empty base,
+// so they add nothing to the size of the container.
+template <
+    typename Alloc,
+    bool Empty = std::is_empty_v<Alloc> && !std::is_final_v<Alloc>>
+class allocator_holder : private Alloc {
+protected:
+    explicit allocator_holder(const Alloc &alloc) : Alloc(alloc) {
+    }
+
+    explicit allocator_holder(Alloc &&alloc) : Alloc(std::move(alloc)) {
+    }
+
+    Alloc &allocator() VECTOR_NOEXCEPT {
+        return *this;
+    }
+
+    const Alloc &allocator() const VECTOR_NOEXCEPT {
+        return *this;
+    }
+};
+
+template <typename Alloc>
+class allocator_holder<Alloc, false> {
+    Alloc m_allocator;
+
+protected:
+    explicit allocator_holder(const Alloc &alloc) : m_allocator(alloc) {
+    }
+
+    explicit allocator_holder(Alloc &&alloc)
+        : m_allocator(std::move(alloc)) {
+    }
+
+    Alloc &allocator() VECTOR_NOEXCEPT {
+        return m_allocator;
+    }
+
+    const Alloc &allocator() const VECTOR_NOEXCEPT {
+        return m_allocator;
+    }
+};
+
+// Room for Capacity elements inside the container object itself.
+template <typename T, size_t Capacity>
+class inline_storage {
+    alignas(T) unsigned char m_buffer[Capacity * sizeof(T)];
+
+protected:
+    T *inline_data() VECTOR_NOEXCEPT {
+        return reinterpret_cast<T *>(m_buffer);
+    }
+
+    const T *inline_data() const VECTOR_NOEXCEPT {
+        return reinterpret_cast<const T *>(m_buffer);
+    }
+};
+
+template <typename T>
+class inline_storage<T, 0> {
+protected:
+    static T *inline_data() VECTOR_NOEXCEPT {
+        return nullptr;
+    }
+};
+}  // namespace detail
+
+// With InlineCapacity > 0 the first InlineCapacity elements are kept inside
+// the object and the allocator is only used beyond that; see small_vector.
+// Moving or swapping such a vector moves its elements while they are inline.
+template <
+    typename T,
+    typename Alloc = std::allocator<T>,
+    typename Growth = power_of_two_growth,
+    size_t InlineCapacity = 0>
+class vector : private detail::allocator_holder<Alloc>,
+               private detail::inline_storage<T, InlineCapacity> {
+    using holder = detail::allocator_holder<Alloc>;
+    using traits = std::allocator_traits<Alloc>;
+
+    static constexpr bool RELOCATE_BITWISE = is_trivially_relocatable_v<T>;
+    static constexpr bool CAN_REALLOCATE =
+        RELOCATE_BITWISE && detail::has_reallocate<Alloc, T>::value;
+    // Whether move assignment may always take over the other buffer.
+    static constexpr bool MOVE_ASSIGNMENT_STEALS =
+        traits::propagate_on_container_move_assignment::value ||
+        traits::is_always_equal::value;
+    // Moving and swapping are noexcept as configured by VECTOR_NOEXCEPT,
+    // unless elements kept inline may throw while being moved.
+    static constexpr bool NOTHROW_MOVE =
+        noexcept(detail::vector_noexcept_probe()) &&
+        (InlineCapacity == 0 || std::is_nothrow_move_constructible_v<T>);
+
+    size_t m_capacity = InlineCapacity;
     size_t m_size = 0;
-    T *m_data = nullptr;
+    T *m_data = this->inline_data();
+
+    using holder::allocator;
 
     void check_index_is_in_range(size_t index) const {
         if (index >= m_size) {
@@ -20,163 +194,465 @@ class vector {
         }
     }
 
+    static bool equal_allocators(const Alloc &lhs, const Alloc &rhs)
+        VECTOR_NOEXCEPT {
+        return traits::is_always_equal::value || lhs == rhs;
+    }
+
+    [[nodiscard]] bool is_inline() const VECTOR_NOEXCEPT {
+        return m_data == this->inline_data();
+    }
+
+    // Capacity to allocate for a vector constructed with `size` elements.
+    // The growth policy only applies once the elements leave the inline
+    // buffer.
+    static size_t initial_capacity(size_t size) VECTOR_NOEXCEPT {
+        return size <= InlineCapacity ? InlineCapacity
+                                      : Growth::next_capacity(0, size);
+    }
+
+    // Allocates room for at least `capacity` elements and updates it to what
+    // the allocator actually handed out, so no usable slack is wasted.
+    // Requests that fit are served by the inline buffer.
+    T *allocate(size_t &capacity) {
+        if (capacity <= InlineCapacity) {
+            capacity = InlineCapacity;
+            return this->inline_data();
+        }
+#ifdef __cpp_lib_allocate_at_least
+        auto result = traits::allocate_at_least(allocator(), capacity);
+        capacity = result.count;
+        return result.ptr;
+#else
+        return traits::allocate(allocator(), capacity);
+#endif
+    }
+
+    void deallocate(T *data, size_t capacity) VECTOR_NOEXCEPT {
+        if (data != nullptr && data != this->inline_data()) {
+            traits::deallocate(allocator(), data, capacity);
+        }
+    }
+
+    template <typename... Args>
+    void construct_element(T *where, Args &&...args) {
+        traits::construct(allocator(), where, std::forward<Args>(args)...);
+    }
+
+    void destroy(T *first, T *last) VECTOR_NOEXCEPT {
+        for (; first != last; ++first) {
+            traits::destroy(allocator(), first);
+        }
+    }
+
+    // Constructs count elements at `to` from the ones at `from`, moving only
+    // when that cannot throw. On failure everything constructed so far is
+    // destroyed and `from` is left untouched. Trivially relocatable elements
+    // are copied with a single memcpy.
+    void relocate(T *from, T *to, size_t count) {
+        if constexpr (RELOCATE_BITWISE) {
+            if (count != 0) {
+                std::memcpy(
+                    static_cast<void *>(to), static_cast<const void *>(from),
+                    count * sizeof(T)
+                );
+            }
+        } else {
+            size_t i = 0;
+            try {
+                for (; i < count; ++i) {
+                    construct_element(to + i, std::move_if_noexcept(from[i]));
+                }
+            } catch (...) {
+                destroy(to, to + i);
+                throw;
+            }
+        }
+    }
+
+    // Ends the lifetime of elements that relocate() has copied elsewhere.
+    void destroy_relocated(T *first, T *last) VECTOR_NOEXCEPT {
+        if constexpr (!RELOCATE_BITWISE) {
+            destroy(first, last);
+        }
+    }
+
+    [[nodiscard]] bool points_into_elements(const T *pointer) const
+        VECTOR_NOEXCEPT {
+        return pointer != nullptr && !std::less<const T *>()(pointer, m_data) &&
+               std::less<const T *>()(pointer, m_data + m_size);
+    }
+
     void reset_size_and_capacity_and_deallocate_memory() VECTOR_NOEXCEPT {
-        Alloc().deallocate(m_data, m_capacity);
+        deallocate(m_data, m_capacity);
+        m_data = this->inline_data();
         m_size = 0;
-        m_capacity = 0;
+        m_capacity = InlineCapacity;
     }
 
     void destruct_redundant_elements(size_t new_size) VECTOR_NOEXCEPT {
-        for (size_t i = new_size; i < m_size; ++i) {
-            m_data[i].~T();
+        destroy(m_data + new_size, m_data + m_size);
+    }
+
+    // Takes over other's heap buffer; our allocator must be able to free
+    // it. other ends up empty.
+    void steal_buffer(vector &other) VECTOR_NOEXCEPT {
+        m_data = std::exchange(other.m_data, other.inline_data());
+        m_capacity = std::exchange(other.m_capacity, InlineCapacity);
+        m_size = std::exchange(other.m_size, 0);
+    }
+
+    // Moves other's elements one by one into this empty vector. other ends
+    // up empty.
+    void move_elements(vector &other) {
+        increase_capacity(other.m_size);
+        construct_tail(other.m_size, [&](T *where, size_t i) {
+            construct_element(where, std::move(other.m_data[i]));
+        });
+        other.clear();
+    }
+
+    // Moves other's elements into this empty vector after our allocator has
+    // been moved from other's. That allocator made other's heap buffer, so
+    // the buffer is taken over whatever state other's allocator is left in.
+    void adopt_elements(vector &other) {
+        if (other.is_inline()) {
+            move_elements(other);
+        } else {
+            steal_buffer(other);
         }
     }
 
-    void decrease_capacity(size_t new_capacity) VECTOR_NOEXCEPT {
-        if (new_capacity == m_capacity) {
+    // Moves other's elements into this empty vector. A heap buffer is taken
+    // over as is when our allocator can free it; inline elements and ones
+    // from an unequal allocator are moved one by one. other ends up empty.
+    void take_elements(vector &other) {
+        if (!other.is_inline() &&
+            equal_allocators(allocator(), other.allocator())) {
+            steal_buffer(other);
             return;
         }
-        Alloc().deallocate(m_data + new_capacity, m_capacity - new_capacity);
-        m_capacity = new_capacity;
+        move_elements(other);
     }
 
-    void swap(vector &&other) VECTOR_NOEXCEPT {
-        std::swap(m_data, other.m_data);
-        std::swap(m_size, other.m_size);
-        std::swap(m_capacity, other.m_capacity);
+    // Exchanges the elements but not the allocators. Buffers on the heap
+    // trade places; inline elements have to be moved.
+    void swap_elements(vector &other) {
+        if (!is_inline() && !other.is_inline()) {
+            std::swap(m_data, other.m_data);
+            std::swap(m_size, other.m_size);
+            std::swap(m_capacity, other.m_capacity);
+            return;
+        }
+        if (!is_inline()) {
+            other.swap_elements(*this);
+            return;
+        }
+        if (!other.is_inline()) {
+            T *data = std::exchange(other.m_data, other.inline_data());
+            size_t capacity = std::exchange(other.m_capacity, InlineCapacity);
+            size_t size = std::exchange(other.m_size, 0);
+            try {
+                other.take_elements(*this);
+            } catch (...) {
+                other.clear();
+                other.m_data = data;
+                other.m_capacity = capacity;
+                other.m_size = size;
+                throw;
+            }
+            m_data = data;
+            m_capacity = capacity;
+            m_size = size;
+            return;
+        }
+        vector &shorter = m_size < other.m_size ? *this : other;
+        vector &longer = m_size < other.m_size ? other : *this;
+        const size_t common = shorter.m_size;
+        for (size_t i = 0; i < common; ++i) {
+            using std::swap;
+            swap(m_data[i], other.m_data[i]);
+        }
+        shorter.construct_tail(longer.m_size, [&](T *where, size_t i) {
+            shorter.construct_element(where, std::move(longer.m_data[i]));
+        });
+        longer.destruct_redundant_elements(common);
+        longer.m_size = common;
+    }
+
+    // Enlarges the buffer without moving the elements if the allocator
+    // supports that.
+    bool try_expand_in_place(size_t new_capacity) {
+        if constexpr (detail::has_expand_in_place<Alloc, T>::value) {
+            if (!is_inline() && new_capacity > m_capacity &&
+                allocator().expand_in_place(
+                    m_data, m_capacity, new_capacity
+                )) {
+                m_capacity = new_capacity;
+                return true;
+            }
+        }
+        return false;
     }
 
-    void increase_capacity(size_t new_size) {
-        if (new_size <= m_capacity) {
+    // Moves the elements into a buffer of new_capacity >= m_size elements.
+    // Strong guarantee.
+    void reallocate(size_t new_capacity) {
+        if (try_expand_in_place(new_capacity)) {
             return;
         }
-        size_t new_capacity = round_up_to_the_power_of_two(new_size);
-        T *new_data = Alloc().allocate(new_capacity);
-        try {
-            for (size_t i = 0; i < m_size; ++i) {
-                new (new_data + i) T(std::move(m_data[i]));
-                m_data[i].~T();
+        if constexpr (CAN_REALLOCATE) {
+            if (!is_inline() && new_capacity > InlineCapacity) {
+                m_data =
+                    allocator().reallocate(m_data, m_capacity, new_capacity);
+                m_capacity = new_capacity;
+                return;
             }
-            Alloc().deallocate(m_data, m_capacity);
-            m_data = new_data;
-            m_capacity = new_capacity;
+        }
+        T *new_data = allocate(new_capacity);
+        try {
+            relocate(m_data, new_data, m_size);
         } catch (...) {
-            Alloc().deallocate(new_data, new_capacity);
+            deallocate(new_data, new_capacity);
             throw;
         }
+        destroy_relocated(m_data, m_data + m_size);
+        deallocate(m_data, m_capacity);
+        m_data = new_data;
+        m_capacity = new_capacity;
     }
 
-    size_t round_up_to_the_power_of_two(size_t x) VECTOR_NOEXCEPT {
-        if (x == 0) {
-            return 0;
-        }
-        size_t res = 1;
-        while (res < x) {
-            res <<= 1;
+    void increase_capacity(size_t new_size) {
+        if (new_size <= m_capacity) {
+            return;
         }
-        return res;
+        reallocate(Growth::next_capacity(m_capacity, new_size));
     }
 
-public:
-    vector() = default;
-
-    explicit vector(size_t size)
-        : m_capacity(round_up_to_the_power_of_two(size)),
-          m_size(size),
-          m_data(Alloc().allocate(m_capacity)) {
+    template <typename Construct>
+    void construct_tail(size_t new_size, Construct construct) {
+        size_t i = m_size;
         try {
-            for (size_t i = 0; i < size; ++i) {
-                new (m_data + i) T();
+            for (; i < new_size; ++i) {
+                construct(m_data + i, i);
             }
         } catch (...) {
-            reset_size_and_capacity_and_deallocate_memory();
+            destroy(m_data + m_size, m_data + i);
             throw;
         }
+        m_size = new_size;
     }
 
-    vector(size_t size, const T &value)
-        : m_capacity(round_up_to_the_power_of_two(size)),
-          m_size(size),
-          m_data(Alloc().allocate(m_capacity)) {
+    // Fills a freshly allocated buffer from a constructor. If an element
+    // throws, the ones built so far are destroyed and the buffer is freed.
+    template <typename Construct>
+    void construct_initial(size_t size, Construct construct) {
         try {
-            for (size_t i = 0; i < size; ++i) {
-                new (m_data + i) T(value);
-            }
+            construct_tail(size, construct);
         } catch (...) {
             reset_size_and_capacity_and_deallocate_memory();
             throw;
         }
     }
 
-    vector(size_t size, T &&value)
-        : m_capacity(round_up_to_the_power_of_two(size)),
-          m_size(size),
-          m_data(Alloc().allocate(m_capacity)) {
+    // Grows the vector to new_size, constructing element i with
+    // construct(pointer, i); `source` is the value the new elements are
+    // made from, if any. New elements are constructed before the old ones
+    // are relocated, so they may be copies of existing elements. Strong
+    // guarantee: on failure size and contents are unchanged, and so is the
+    // capacity unless the allocator grew the buffer in place.
+    template <typename Construct>
+    void grow(size_t new_size, Construct construct, const T *source) {
+        if (new_size <= m_capacity) {
+            construct_tail(new_size, construct);
+            return;
+        }
+
+        size_t new_capacity = Growth::next_capacity(m_capacity, new_size);
+        if (try_expand_in_place(new_capacity)) {
+            construct_tail(new_size, construct);
+            return;
+        }
+        if constexpr (CAN_REALLOCATE) {
+            if (!is_inline() && !points_into_elements(source)) {
+                reallocate(new_capacity);
+                construct_tail(new_size, construct);
+                return;
+            }
+        }
+        T *new_data = allocate(new_capacity);
+        size_t i = m_size;
         try {
-            if (size > 1) {
-                for (size_t i = 0; i < size; ++i) {
-                    new (m_data + i) T(value);
-                }
-            } else {
-                new (m_data) T(std::move(value));
+            for (; i < new_size; ++i) {
+                construct(new_data + i, i);
             }
+            relocate(m_data, new_data, m_size);
         } catch (...) {
-            reset_size_and_capacity_and_deallocate_memory();
+            destroy(new_data + m_size, new_data + i);
+            deallocate(new_data, new_capacity);
             throw;
         }
+        destroy_relocated(m_data, m_data + m_size);
+        deallocate(m_data, m_capacity);
+        m_data = new_data;
+        m_capacity = new_capacity;
+        m_size = new_size;
     }
 
-    vector(const vector &other)
-        : m_capacity(round_up_to_the_power_of_two(other.m_size)),
-          m_size(other.m_size),
-          m_data(Alloc().allocate(m_capacity)) {
-        try {
-            for (size_t i = 0; i < m_size; ++i) {
-                new (m_data + i) T(other.m_data[i]);
-            }
-        } catch (...) {
+    // Replaces the contents with copies of other's elements. Strong
+    // guarantee when other is longer, as the copy is built aside first.
+    void assign_elements(const vector &other) {
+        if (m_size < other.m_size) {
+            vector tmp(other, allocator());
+            clear();
             reset_size_and_capacity_and_deallocate_memory();
-            throw;
+            take_elements(tmp);
+            return;
+        }
+        for (size_t i = 0; i < other.m_size; ++i) {
+            m_data[i] = other.m_data[i];
         }
+        destruct_redundant_elements(other.m_size);
+        m_size = other.m_size;
     }
 
-    vector(vector &&other) VECTOR_NOEXCEPT
-        : m_capacity(std::exchange(other.m_capacity, 0)),
-          m_size(std::exchange(other.m_size, 0)),
-          m_data(std::exchange(other.m_data, nullptr)) {
+public:
+    using value_type = T;
+    using allocator_type = Alloc;
+
+    vector() : vector(Alloc()) {
     }
 
-    vector &operator=(vector &&other) VECTOR_NOEXCEPT {
-        if (this != &other) {
-            clear();
-            swap(std::move(other));
-            decrease_capacity(round_up_to_the_power_of_two(m_size));
+    explicit vector(const Alloc &alloc) VECTOR_NOEXCEPT : holder(alloc) {
+    }
+
+    explicit vector(size_t size, const Alloc &alloc = Alloc())
+        : holder(alloc),
+          m_capacity(initial_capacity(size)),
+          m_data(allocate(m_capacity)) {
+        construct_initial(size, [&](T *where, size_t) {
+            construct_element(where);
+        });
+    }
+
+    vector(size_t size, const T &value, const Alloc &alloc = Alloc())
+        : holder(alloc),
+          m_capacity(initial_capacity(size)),
+          m_data(allocate(m_capacity)) {
+        construct_initial(size, [&](T *where, size_t) {
+            construct_element(where, value);
+        });
+    }
+
+    vector(size_t size, T &&value, const Alloc &alloc = Alloc())
+        : holder(alloc),
+          m_capacity(initial_capacity(size)),
+          m_data(allocate(m_capacity)) {
+        construct_initial(size, [&](T *where, size_t) {
+            if (size == 1) {
+                construct_element(where, std::move(value));
+            } else {
+                construct_element(where, value);
+            }
+        });
+    }
+
+    vector(std::initializer_list<T> values, const Alloc &alloc = Alloc())
+        : holder(alloc),
+          m_capacity(initial_capacity(values.size())),
+          m_data(allocate(m_capacity)) {
+        construct_initial(values.size(), [&](T *where, size_t i) {
+            construct_element(where, values.begin()[i]);
+        });
+    }
+
+    vector(const vector &other)
+        : vector(
+              other,
+              traits::select_on_container_copy_construction(other.allocator())
+          ) {
+    }
+
+    vector(const vector &other, const Alloc &alloc)
+        : holder(alloc),
+          m_capacity(initial_capacity(other.m_size)),
+          m_data(allocate(m_capacity)) {
+        construct_initial(other.m_size, [&](T *where, size_t i) {
+            construct_element(where, other.m_data[i]);
+        });
+    }
+
+    vector(vector &&other) noexcept(NOTHROW_MOVE)
+        : holder(std::move(other.allocator())) {
+        adopt_elements(other);
+    }
+
+    // Takes over other's buffer if alloc can free it, otherwise moves the
+    // elements one by one.
+    vector(vector &&other, const Alloc &alloc) : holder(alloc) {
+        take_elements(other);
+    }
+
+    // Takes over other's buffer when the allocators allow it, otherwise
+    // moves the elements one by one into storage from our own allocator.
+    vector &operator=(vector &&other
+    ) noexcept(MOVE_ASSIGNMENT_STEALS && NOTHROW_MOVE) {
+        if (this == &other) {
+            return *this;
+        }
+        clear();
+        reset_size_and_capacity_and_deallocate_memory();
+        if constexpr (traits::propagate_on_container_move_assignment::value) {
+            allocator() = std::move(other.allocator());
+            adopt_elements(other);
+        } else {
+            take_elements(other);
         }
         return *this;
     }
 
     vector &operator=(const vector &other) {
-        if (this != &other) {
-            if (m_size < other.m_size) {
-                vector tmp(other);
-                *this = std::move(tmp);
-                decrease_capacity(round_up_to_the_power_of_two(m_size));
-            } else {
-                for (size_t i = 0; i < other.m_size; ++i) {
-                    m_data[i] = other.m_data[i];
-                }
-                destruct_redundant_elements(other.m_size);
-                m_size = other.m_size;
+        if (this == &other) {
+            return *this;
+        }
+        if constexpr (traits::propagate_on_container_copy_assignment::value) {
+            if (!equal_allocators(allocator(), other.allocator())) {
+                // Our buffer must go back to our allocator before we adopt
+                // other's.
+                vector tmp(other, other.allocator());
+                clear();
+                reset_size_and_capacity_and_deallocate_memory();
+                allocator() = other.allocator();
+                take_elements(tmp);
+                return *this;
             }
+            allocator() = other.allocator();
         }
+        assign_elements(other);
         return *this;
     }
 
     ~vector() VECTOR_NOEXCEPT {
-        if (m_data != nullptr) {
-            clear();
-            Alloc().deallocate(m_data, m_capacity);
+        clear();
+        deallocate(m_data, m_capacity);
+    }
+
+    // Swapping vectors with unequal allocators that do not propagate on
+    // swap is undefined, as for standard containers.
+    void swap(vector &other) noexcept(NOTHROW_MOVE) {
+        if constexpr (traits::propagate_on_container_swap::value) {
+            using std::swap;
+            swap(allocator(), other.allocator());
         }
+        swap_elements(other);
+    }
+
+    friend void swap(vector &lhs, vector &rhs) noexcept(NOTHROW_MOVE) {
+        lhs.swap(rhs);
+    }
+
+    [[nodiscard]] Alloc get_allocator() const VECTOR_NOEXCEPT {
+        return allocator();
     }
 
     [[nodiscard]] size_t size() const VECTOR_NOEXCEPT {
@@ -192,108 +668,76 @@ public:
     }
 
     void clear() VECTOR_NOEXCEPT {
-        for (size_t i = 0; i < m_size; ++i) {
-            m_data[i].~T();
-        }
+        destroy(m_data, m_data + m_size);
         m_size = 0;
     }
 
     void push_back(const T &value) {
-        if (m_size + 1 <= m_capacity) {
-            new (m_data + m_size) T(value);
-        } else {
-            size_t new_capacity = round_up_to_the_power_of_two(m_size + 1);
-            T *new_data = Alloc().allocate(new_capacity);
-            try {
-                new (new_data + m_size) T(value);
-                for (size_t i = 0; i < m_size; ++i) {
-                    new (new_data + i) T(std::move(m_data[i]));
-                    m_data[i].~T();
-                }
-                Alloc().deallocate(m_data, m_capacity);
-                m_data = new_data;
-                m_capacity = new_capacity;
-            } catch (...) {
-                Alloc().deallocate(new_data, new_capacity);
-                throw;
-            }
-        }
-        ++m_size;
+        grow(
+            m_size + 1,
+            [&](T *where, size_t) { construct_element(where, value); }, &value
+        );
     }
 
     void push_back(T &&value) {
-        increase_capacity(m_size + 1);
-        new (m_data + m_size) T(std::move(value));
-        ++m_size;
+        grow(
+            m_size + 1,
+            [&](T *where, size_t) {
+                construct_element(where, std::move(value));
+            },
+            &value
+        );
     }
 
     void pop_back() {
-        m_data[m_size - 1].~T();
+        traits::destroy(allocator(), m_data + m_size - 1);
         --m_size;
     }
 
     void resize(size_t new_size) {
-        destruct_redundant_elements(new_size);
-
-        size_t old_capacity = m_capacity;
-        increase_capacity(new_size);
-        try {
-            for (size_t i = m_size; i < new_size; ++i) {
-                new (m_data + i) T();
-            }
-        } catch (...) {
-            decrease_capacity(old_capacity);
-            throw;
+        if (new_size <= m_size) {
+            destruct_redundant_elements(new_size);
+            m_size = new_size;
+            return;
         }
-        m_size = new_size;
+        grow(
+            new_size, [&](T *where, size_t) { construct_element(where); },
+            nullptr
+        );
     }
 
     void resize(size_t new_size, const T &new_value) {
-        destruct_redundant_elements(new_size);
-        if (new_size <= m_capacity) {
-            for (size_t i = m_size; i < new_size; ++i) {
-                new (m_data + i) T(new_value);
-            }
-        } else {
-            size_t new_capacity = round_up_to_the_power_of_two(new_size);
-            T *new_data = Alloc().allocate(new_capacity);
-            try {
-                new (new_data + m_size) T(new_value);
-                for (size_t i = 0; i < m_size; ++i) {
-                    new (new_data + i) T(std::move(m_data[i]));
-                    m_data[i].~T();
-                }
-                Alloc().deallocate(m_data, m_capacity);
-                for (size_t i = m_size + 1; i < new_size; ++i) {
-                    new (new_data + i) T(new_data[m_size]);
-                }
-                m_data = new_data;
-                m_capacity = new_capacity;
-            } catch (...) {
-                Alloc().deallocate(new_data, new_capacity);
-                throw;
-            }
+        if (new_size <= m_size) {
+            destruct_redundant_elements(new_size);
+            m_size = new_size;
+            return;
         }
-        m_size = new_size;
+        grow(
+            new_size,
+            [&](T *where, size_t) { construct_element(where, new_value); },
+            &new_value
+        );
     }
 
     void resize(size_t new_size, T &&new_value) {
-        destruct_redundant_elements(new_size);
-        size_t old_capacity = m_capacity;
-        increase_capacity(new_size);
-        try {
-            if (new_size > 1) {
-                for (size_t i = m_size; i < new_size; ++i) {
-                    new (m_data + i) T(new_value);
-                }
-            } else {
-                new (m_data) T(std::move(new_value));
-            }
-        } catch (...) {
-            decrease_capacity(old_capacity);
-            throw;
+        if (new_size <= m_size) {
+            destruct_redundant_elements(new_size);
+            m_size = new_size;
+            return;
         }
-        m_size = new_size;
+        // A single new element may take the value itself.
+        const bool move_value = new_size == m_size + 1;
+        grow(
+            new_size,
+            [&](T *where, size_t) {
+                if (move_value) {
+                    construct_element(where, std::move(new_value));
+                } else {
+                    construct_element(where, new_value);
+                }
+            },
+            &new_value
+        );
     }
 
     T &operator[](std::size_t index) & {
@@ -342,7 +786,19 @@ public:
     void reserve(size_t new_capacity) {
         increase_capacity(new_capacity);
     }
+
+    // Releases unused capacity. Strong guarantee.
+    void shrink_to_fit() {
+        if (m_capacity == m_size || is_inline()) {
+            return;
+        }
+        if (m_size == 0) {
+            reset_size_and_capacity_and_deallocate_memory();
+            return;
+        }
+        reallocate(m_size);
+    }
 };
 }  // namespace lab_vector_naive
 
-#endif  // VECTOR_HPP_
\ No newline at end of file
+#endif  // VECTOR_HPP_
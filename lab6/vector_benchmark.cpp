@@ -0,0 +1,501 @@
+// Benchmark of lab_vector_naive::vector against std::vector.
+//
+//     vector_benchmark [elements] [repetitions]
+//
+// Both containers run the same operations on several element types through
+// an instrumented allocator. For every operation the mean time per element,
+// the number of allocations and the peak number of allocated bytes are
+// reported, after checking that both containers end up with equal contents.
+// soa_vector is checked to keep its elements intact when relocating them
+// fails halfway, and small_vector to build up to N elements without
+// allocating. Move construction must take over the buffer even when the
+// moved-from allocator compares unequal. Vectors on malloc_allocator and
+// mmap_allocator are grown
+// element by element and checked to keep their contents; on mmap_allocator
+// the growth has to leave the first reservation behind.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "malloc_allocator.hpp"
+#include "mmap_allocator.hpp"
+#include "small_vector.hpp"
+#include "soa_vector.hpp"
+#include "vector.hpp"
+
+namespace {
+struct allocation_stats {
+    std::size_t allocations = 0;
+    std::size_t bytes = 0;
+    std::size_t peak_bytes = 0;
+};
+
+allocation_stats stats;
+
+// std::allocator that records every allocation in `stats`.
+template <typename T>
+struct counting_allocator {
+    using value_type = T;
+
+    counting_allocator() = default;
+
+    template <typename U>
+    // cppcheck-suppress noExplicitConstructor
+    counting_allocator(const counting_allocator<U> &) noexcept {
+    }
+
+    T *allocate(std::size_t count) {
+        stats.allocations++;
+        stats.bytes += count * sizeof(T);
+        stats.peak_bytes = std::max(stats.peak_bytes, stats.bytes);
+        return std::allocator<T>().allocate(count);
+    }
+
+    void deallocate(T *data, std::size_t count) noexcept {
+        stats.bytes -= count * sizeof(T);
+        std::allocator<T>().deallocate(data, count);
+    }
+
+    friend bool
+    operator==(const counting_allocator &, const counting_allocator &) {
+        return true;
+    }
+
+    friend bool
+    operator!=(const counting_allocator &, const counting_allocator &) {
+        return false;
+    }
+};
+
+// Stateful allocator that hands its state over when moved, so the
+// moved-from one compares unequal to where it went.
+template <typename T>
+struct handing_over_allocator {
+    using value_type = T;
+    using propagate_on_container_move_assignment = std::true_type;
+
+    int id = 1;
+
+    handing_over_allocator() = default;
+
+    template <typename U>
+    // cppcheck-suppress noExplicitConstructor
+    handing_over_allocator(const handing_over_allocator<U> &other) noexcept
+        : id(other.id) {
+    }
+
+    handing_over_allocator(const handing_over_allocator &) = default;
+
+    handing_over_allocator(handing_over_allocator &&other) noexcept
+        : id(std::exchange(other.id, 0)) {
+    }
+
+    handing_over_allocator &
+    operator=(const handing_over_allocator &) = default;
+
+    handing_over_allocator &operator=(handing_over_allocator &&other
+    ) noexcept {
+        id = std::exchange(other.id, 0);
+        return *this;
+    }
+
+    T *allocate(std::size_t count) {
+        stats.allocations++;
+        return std::allocator<T>().allocate(count);
+    }
+
+    void deallocate(T *data, std::size_t count) noexcept {
+        std::allocator<T>().deallocate(data, count);
+    }
+
+    friend bool operator==(
+        const handing_over_allocator &lhs,
+        const handing_over_allocator &rhs
+    ) {
+        return lhs.id == rhs.id;
+    }
+
+    friend bool operator!=(
+        const handing_over_allocator &lhs,
+        const handing_over_allocator &rhs
+    ) {
+        return !(lhs == rhs);
+    }
+};
+
+// Its copy constructor may throw, so containers must copy rather than move
+// it when they relocate elements.
+struct throwing {
+    int value = 0;
+
+    throwing() = default;
+
+    explicit throwing(int number) : value(number) {
+    }
+
+    throwing(const throwing &other) : value(other.value) {
+        if (value < 0) {
+            throw std::runtime_error("Negative value");
+        }
+    }
+
+    throwing(throwing &&other) noexcept(false) : value(other.value) {
+        if (value < 0) {
+            throw std::runtime_error("Negative value");
+        }
+    }
+
+    throwing &operator=(const throwing &) = default;
+
+    bool operator==(const throwing &other) const {
+        return value == other.value;
+    }
+};
+
+struct large_pod {
+    std::array<long long, 32> values;
+
+    bool operator==(const large_pod &other) const {
+        return values == other.values;
+    }
+};
+
+template <typename T>
+T make(std::size_t i);
+
+template <>
+int make<int>(std::size_t i) {
+    return static_cast<int>(i);
+}
+
+template <>
+std::string make<std::string>(std::size_t i) {
+    // Longer than the small-string buffer, so copies allocate.
+    return "element number " + std::to_string(i) + " of the benchmark";
+}
+
+template <>
+throwing make<throwing>(std::size_t i) {
+    return throwing(static_cast<int>(i));
+}
+
+template <>
+large_pod make<large_pod>(std::size_t i) {
+    large_pod result{};
+    result.values.fill(static_cast<long long>(i));
+    return result;
+}
+
+template <typename T>
+using std_vector = std::vector<T, counting_allocator<T>>;
+
+template <typename T>
+using lab_vector = lab_vector_naive::vector<T, counting_allocator<T>>;
+
+template <typename Lhs, typename Rhs>
+bool same_contents(const Lhs &lhs, const Rhs &rhs) {
+    return lhs.size() == rhs.size() &&
+           std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+struct measurement {
+    double ns_per_element = 0;
+    std::size_t allocations = 0;
+    std::size_t peak_bytes = 0;
+};
+
+int mismatches = 0;
+
+// Runs operation(container) `repetitions` times on fresh containers built
+// by prepare(), timing only the operation, and keeps the last result for
+// the comparison.
+template <typename Container, typename Prepare, typename Operation>
+measurement measure(
+    std::size_t elements,
+    std::size_t repetitions,
+    Container &last,
+    Prepare prepare,
+    Operation operation
+) {
+    using clock = std::chrono::steady_clock;
+    measurement result;
+    clock::duration total = clock::duration::zero();
+    for (std::size_t i = 0; i < repetitions; i++) {
+        Container container;
+        prepare(container);
+        stats = allocation_stats{};
+        const auto start = clock::now();
+        operation(container);
+        total += clock::now() - start;
+        result.allocations = stats.allocations;
+        result.peak_bytes = stats.peak_bytes;
+        if (i + 1 == repetitions) {
+            last = std::move(container);
+        }
+    }
+    result.ns_per_element = std::chrono::duration<double, std::nano>(total)
+                                .count() /
+                            static_cast<double>(repetitions * elements);
+    return result;
+}
+
+void report(
+    const std::string &type,
+    const std::string &operation,
+    const std::string &container,
+    const measurement &result
+) {
+    std::cout << std::left << std::setw(12) << type << std::setw(16)
+              << operation << std::setw(8) << container << std::right
+              << std::setw(12) << std::fixed << std::setprecision(2)
+              << result.ns_per_element << std::setw(10) << result.allocations
+              << std::setw(14) << result.peak_bytes << "\n";
+}
+
+// Measures one operation on both containers and compares their contents.
+template <typename T, typename Prepare, typename Operation>
+void compare(
+    const std::string &type,
+    const std::string &operation_name,
+    std::size_t elements,
+    std::size_t repetitions,
+    Prepare prepare,
+    Operation operation
+) {
+    std_vector<T> std_result;
+    lab_vector<T> lab_result;
+    const measurement std_time =
+        measure(elements, repetitions, std_result, prepare, operation);
+    const measurement lab_time =
+        measure(elements, repetitions, lab_result, prepare, operation);
+    report(type, operation_name, "std", std_time);
+    report(type, operation_name, "lab", lab_time);
+    if (!same_contents(std_result, lab_result)) {
+        mismatches++;
+        std::cout << "MISMATCH " << type << " " << operation_name << "\n";
+    }
+}
+
+template <typename T>
+void benchmark_type(
+    const std::string &type,
+    std::size_t elements,
+    std::size_t repetitions
+) {
+    std::vector<T> values;
+    for (std::size_t i = 0; i < elements; i++) {
+        values.push_back(make<T>(i));
+    }
+    auto nothing = [](auto &) {};
+
+    compare<T>(
+        type, "push_back copy", elements, repetitions, nothing,
+        [&](auto &container) {
+            for (const T &value : values) {
+                container.push_back(value);
+            }
+        }
+    );
+    compare<T>(
+        type, "push_back move", elements, repetitions, nothing,
+        [&](auto &container) {
+            for (std::size_t i = 0; i < elements; i++) {
+                container.push_back(make<T>(i));
+            }
+        }
+    );
+    compare<T>(
+        type, "resize", elements, repetitions, nothing,
+        [&](auto &container) { container.resize(elements, values[0]); }
+    );
+    // Sixteen large steps, so every one of them reallocates or reuses
+    // slack left by the growth policy.
+    compare<T>(
+        type, "growth", elements, repetitions, nothing,
+        [&](auto &container) {
+            const std::size_t step = std::max<std::size_t>(elements / 16, 1);
+            while (container.size() < elements) {
+                container.resize(
+                    std::min(container.size() + step, elements), values[0]
+                );
+            }
+        }
+    );
+    compare<T>(
+        type, "copy-assign", elements, repetitions,
+        [&](auto &container) { container.push_back(values[0]); },
+        [&](auto &container) {
+            // Built once per container type; the first repetition counts
+            // its allocations too, but only the last one is reported.
+            using container_type = std::decay_t<decltype(container)>;
+            static container_type source;
+            if (source.size() != elements) {
+                source.clear();
+                for (const T &value : values) {
+                    source.push_back(value);
+                }
+            }
+            container = source;
+        }
+    );
+}
+
+// A std::string field is nothrow movable, a throwing one is not; reserve()
+// must copy both, so that when a copy of the second field fails the first
+// one still holds its strings.
+void check_soa_strong_guarantee() {
+    lab_vector_naive::soa_vector<std::string, throwing> elements;
+    elements.push_back(make<std::string>(0), throwing(1));
+    elements.push_back(make<std::string>(1), throwing(2));
+    // Copies of this one throw.
+    std::get<1>(elements[1]).value = -1;
+    bool threw = false;
+    try {
+        elements.reserve(elements.capacity() * 4);
+    } catch (const std::runtime_error &) {
+        threw = true;
+    }
+    const bool intact = elements.size() == 2 &&
+                        std::get<0>(elements[0]) == make<std::string>(0) &&
+                        std::get<0>(elements[1]) == make<std::string>(1) &&
+                        std::get<1>(elements[0]).value == 1;
+    if (!threw || !intact) {
+        std::cout << "soa_vector lost elements when relocation failed\n";
+        mismatches++;
+    }
+}
+
+// A vector that has moved the allocator over owns the one that made the
+// buffer, so it must take the buffer over rather than compare allocators
+// and move the elements.
+void check_move_keeps_buffer() {
+    using moved_vector = lab_vector_naive::
+        vector<std::string, handing_over_allocator<std::string>>;
+    moved_vector source;
+    for (std::size_t i = 0; i < 3; i++) {
+        source.push_back(make<std::string>(i));
+    }
+    moved_vector assigned;
+    assigned.push_back(make<std::string>(3));
+    const std::string *data = source.begin();
+    stats = allocation_stats{};
+    moved_vector constructed(std::move(source));
+    assigned = std::move(constructed);
+    if (assigned.begin() != data || stats.allocations != 0 ||
+        assigned.size() != 3 || assigned[2] != make<std::string>(2)) {
+        std::cout << "moving did not take over the buffer\n";
+        mismatches++;
+    }
+}
+
+// Builds `count` elements by push_back in a vector on Alloc, checks them
+// and a copy of them, and returns how often the buffer moved.
+template <typename T, typename Alloc>
+std::size_t grow_and_check(const std::string &name, std::size_t count) {
+    lab_vector_naive::vector<T, Alloc> container;
+    std::size_t moves = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        const T *before = container.begin();
+        container.push_back(make<T>(i));
+        if (i != 0 && container.begin() != before) {
+            moves++;
+        }
+    }
+    bool intact = container.size() == count;
+    for (std::size_t i = 0; intact && i < count; i++) {
+        intact = container[i] == make<T>(i);
+    }
+    const lab_vector_naive::vector<T, Alloc> copy(container);
+    if (!intact || !same_contents(copy, container)) {
+        std::cout << "vector on " << name << " lost elements growing\n";
+        mismatches++;
+    }
+    return moves;
+}
+
+// realloc() carries trivially relocatable elements along; the others are
+// relocated one by one.
+void check_malloc_growth(std::size_t elements) {
+    using lab_vector_naive::malloc_allocator;
+    grow_and_check<int, malloc_allocator<int>>("malloc_allocator", elements);
+    grow_and_check<large_pod, malloc_allocator<large_pod>>(
+        "malloc_allocator", elements
+    );
+    grow_and_check<std::string, malloc_allocator<std::string>>(
+        "malloc_allocator", elements
+    );
+}
+
+// 8 MiB of elements outgrow the reservation of the first block, so the
+// buffer has to move to a new one; apart from that it grows in place,
+// where doubling alone would move it about fifteen times.
+void check_mmap_growth() {
+    constexpr std::size_t COUNT = (std::size_t(8) << 20) / sizeof(large_pod);
+    const std::size_t moves =
+        grow_and_check<large_pod, lab_vector_naive::mmap_allocator<large_pod>>(
+            "mmap_allocator", COUNT
+        );
+    if (moves == 0 || moves > 2) {
+        std::cout << "vector on mmap_allocator moved its buffer " << moves
+                  << " times\n";
+        mismatches++;
+    }
+}
+
+// Every way of constructing at most N elements must use the inline buffer.
+void check_small_vector_inline() {
+    constexpr std::size_t N = 12;
+    using small =
+        lab_vector_naive::small_vector<int, N, counting_allocator<int>>;
+    stats = allocation_stats{};
+    const small by_size(N - 2);
+    const small by_value(N, 7);
+    const small from_list{1, 2, 3, 4, 5, 6, 7, 8, 9, 10};
+    const small copy(from_list);
+    const bool contents = by_size.size() == N - 2 && by_value.size() == N &&
+                          by_value[N - 1] == 7 && from_list.size() == 10 &&
+                          from_list[9] == 10 &&
+                          same_contents(copy, from_list);
+    if (stats.allocations != 0 || !contents) {
+        std::cout << "small_vector allocated for " << N
+                  << " or fewer elements\n";
+        mismatches++;
+    }
+}
+}  // namespace
+
+int main(int argc, char **argv) {
+    const std::size_t elements =
+        argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+    const std::size_t repetitions =
+        argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 20;
+
+    std::cout << std::left << std::setw(12) << "type" << std::setw(16)
+              << "operation" << std::setw(8) << "vector" << std::right
+              << std::setw(12) << "ns/element" << std::setw(10) << "allocs"
+              << std::setw(14) << "peak bytes\n";
+    benchmark_type<int>("int", elements, repetitions);
+    benchmark_type<std::string>("std::string", elements, repetitions);
+    benchmark_type<throwing>("throwing", elements, repetitions);
+    benchmark_type<large_pod>("large_pod", elements, repetitions);
+    check_soa_strong_guarantee();
+    check_small_vector_inline();
+    check_move_keeps_buffer();
+    check_malloc_growth(elements);
+    check_mmap_growth();
+    if (mismatches != 0) {
+        std::cout << mismatches << " operation(s) left different contents\n";
+        return 1;
+    }
+    return 0;
+}